@@ -1,5 +1,6 @@
 #include "Agent.h"
 #include "Behaviour.h"
+#include "JobSystem.h"
 
 namespace ai {
 
@@ -13,4 +14,42 @@ void Agent::executeBehaviours() {
 		behaviour->execute(this);
 }
 
+glm::vec3 Agent::getSharedVelocity() {
+
+	if (m_shared)
+		return m_sharedVelocity;
+
+	glm::vec3* velocity = nullptr;
+	if (m_blackboard.get("velocity", &velocity) &&
+		velocity != nullptr)
+		return *velocity;
+
+	return glm::vec3(0);
+}
+
+void Agent::executeBehaviours(app::JobSystem& jobs, std::vector<Agent>& agents) {
+
+	unsigned int count = (unsigned int)agents.size();
+
+	// everyone's state before anyone moves
+	jobs.parallelFor(0, count, [&agents](unsigned int begin, unsigned int end) {
+		for (unsigned int i = begin; i < end; ++i) {
+			Agent& agent = agents[i];
+			agent.m_sharedVelocity = agent.getSharedVelocity();
+			agent.m_sharedPosition = agent.getPosition();
+			agent.m_shared = true;
+		}
+	});
+
+	jobs.parallelFor(0, count, [&agents](unsigned int begin, unsigned int end) {
+		for (unsigned int i = begin; i < end; ++i)
+			agents[i].executeBehaviours();
+	});
+
+	jobs.parallelFor(0, count, [&agents](unsigned int begin, unsigned int end) {
+		for (unsigned int i = begin; i < end; ++i)
+			agents[i].m_shared = false;
+	});
+}
+
 } // namespace ai
\ No newline at end of file
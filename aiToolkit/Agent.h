@@ -4,6 +4,10 @@
 
 #include "Blackboard.h"
 
+namespace app {
+	class JobSystem;
+}
+
 namespace ai {
 
 class Behaviour;
@@ -11,7 +15,7 @@ class Behaviour;
 class Agent {
 public:
 
-	Agent() : m_transform(1) {}
+	Agent() : m_transform(1), m_shared(false) {}
 	virtual ~Agent() {}
 
 	// add a behaviour
@@ -19,6 +23,18 @@ public:
 
 	// update game object and execute behaviours
 	virtual void executeBehaviours();
+
+	// executes every agent's behaviours spread across a job system's
+	// threads. For as long as it runs, getSharedPosition() and
+	// getSharedVelocity() return copies taken before any agent moved,
+	// so behaviours can read other agents through them but must not
+	// write to other agents
+	static void executeBehaviours(app::JobSystem& jobs, std::vector<Agent>& agents);
+
+	// the position and "velocity" blackboard entry that other agents should
+	// read, the agent's own unless it is in a parallel update
+	glm::vec3 getSharedPosition() const { return m_shared ? m_sharedPosition : getPosition(); }
+	glm::vec3 getSharedVelocity();
 	
 	Blackboard&	getBlackboard() { return m_blackboard; }
 
@@ -34,6 +50,11 @@ protected:
 	
 	Blackboard				m_blackboard;
 	std::vector<Behaviour*>	m_behaviours;
+
+	// copied at the start of a parallel update
+	bool					m_shared;
+	glm::vec3				m_sharedPosition;
+	glm::vec3				m_sharedVelocity;
 };
 
 } // namespace ai
\ No newline at end of file
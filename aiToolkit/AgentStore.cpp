@@ -0,0 +1,47 @@
+#include "AgentStore.h"
+
+namespace ai {
+
+unsigned int AgentStore::add(const glm::vec3& position, const glm::vec3& velocity,
+							 float maxForce, float maxVelocity) {
+
+	unsigned int index = getCount();
+
+	for (auto& component : m_components)
+		component.push_back(0);
+	m_randomStates.push_back(0);
+
+	AgentView agent(this, index);
+	agent.setPosition(position);
+	agent.setVelocity(velocity);
+	agent.setMaxForce(maxForce);
+	agent.setMaxVelocity(maxVelocity);
+
+	return index;
+}
+
+void AgentStore::setWander(unsigned int index, float offset, float radius, float jitter,
+						   const glm::vec3& axisWeights, unsigned int randomState) {
+
+	m_components[WANDER_OFFSET][index] = offset;
+	m_components[WANDER_RADIUS][index] = radius;
+	m_components[WANDER_JITTER][index] = jitter;
+	m_components[WANDER_AXIS_X][index] = axisWeights.x;
+	m_components[WANDER_AXIS_Y][index] = axisWeights.y;
+	m_components[WANDER_AXIS_Z][index] = axisWeights.z;
+	m_randomStates[index] = randomState;
+}
+
+void AgentStore::reserve(unsigned int count) {
+	for (auto& component : m_components)
+		component.reserve(count);
+	m_randomStates.reserve(count);
+}
+
+void AgentStore::clear() {
+	for (auto& component : m_components)
+		component.clear();
+	m_randomStates.clear();
+}
+
+} // namespace ai
\ No newline at end of file
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace ai {
+
+// the parts of an agent a SteeringSystem moves, each held in its own
+// array so that a force can be applied to every agent in one loop
+enum eAgentComponent {
+	POSITION_X = 0,
+	POSITION_Y,
+	POSITION_Z,
+	VELOCITY_X,
+	VELOCITY_Y,
+	VELOCITY_Z,
+	MAX_FORCE,
+	MAX_VELOCITY,
+
+	// wander state, the same as WanderData, apart from the random
+	// state which is held separately (see getRandomStates())
+	WANDER_TARGET_X,
+	WANDER_TARGET_Y,
+	WANDER_TARGET_Z,
+	WANDER_OFFSET,
+	WANDER_RADIUS,
+	WANDER_JITTER,
+	WANDER_AXIS_X,
+	WANDER_AXIS_Y,
+	WANDER_AXIS_Z,
+
+	AGENT_COMPONENT_COUNT
+};
+
+class AgentView;
+
+// agents stored as a structure of arrays rather than as ai::Agent objects,
+// for steering large numbers of them with a SteeringSystem. Agents are
+// referred to by index, or through an AgentView of an index
+class AgentStore {
+public:
+
+	AgentStore() {}
+	~AgentStore() {}
+
+	// adds an agent that doesn't wander, returning its index
+	unsigned int add(const glm::vec3& position, const glm::vec3& velocity,
+					 float maxForce, float maxVelocity);
+
+	// agents with a wander radius of 0 don't wander. The random state is
+	// as WanderData::randomState, with 0 seeding it on first use
+	void setWander(unsigned int index, float offset, float radius, float jitter,
+				   const glm::vec3& axisWeights = glm::vec3(1), unsigned int randomState = 0);
+
+	void reserve(unsigned int count);
+	void clear();
+
+	unsigned int getCount() const { return (unsigned int)m_components[0].size(); }
+
+	// the array of one component, with an entry for each agent
+	float* getComponent(eAgentComponent component) { return m_components[component].data(); }
+	const float* getComponent(eAgentComponent component) const { return m_components[component].data(); }
+
+	// each agent's wander random state, kept apart as it isn't a float
+	unsigned int* getRandomStates() { return m_randomStates.data(); }
+	const unsigned int* getRandomStates() const { return m_randomStates.data(); }
+
+	float get(eAgentComponent component, unsigned int index) const { return m_components[component][index]; }
+	void set(eAgentComponent component, unsigned int index, float value) { m_components[component][index] = value; }
+
+	AgentView getAgent(unsigned int index);
+
+protected:
+
+	std::vector<float>	m_components[AGENT_COMPONENT_COUNT];
+
+	std::vector<unsigned int>	m_randomStates;
+};
+
+// a single agent in a store, read and written in place. Views
+// stay valid as agents are added, until the store is cleared
+class AgentView {
+public:
+
+	AgentView() : m_store(nullptr), m_index(0) {}
+	AgentView(AgentStore* store, unsigned int index) : m_store(store), m_index(index) {}
+	~AgentView() {}
+
+	AgentStore* getStore() const { return m_store; }
+	unsigned int getIndex() const { return m_index; }
+
+	glm::vec3 getPosition() const { return get(POSITION_X); }
+	void setPosition(const glm::vec3& v) { set(POSITION_X, v); }
+	void translate(const glm::vec3& v) { set(POSITION_X, get(POSITION_X) + v); }
+
+	glm::vec3 getVelocity() const { return get(VELOCITY_X); }
+	void setVelocity(const glm::vec3& v) { set(VELOCITY_X, v); }
+
+	float getMaxForce() const { return m_store->get(MAX_FORCE, m_index); }
+	void setMaxForce(float maxForce) { m_store->set(MAX_FORCE, m_index, maxForce); }
+
+	float getMaxVelocity() const { return m_store->get(MAX_VELOCITY, m_index); }
+	void setMaxVelocity(float maxVelocity) { m_store->set(MAX_VELOCITY, m_index, maxVelocity); }
+
+	glm::vec3 getWanderTarget() const { return get(WANDER_TARGET_X); }
+	void setWanderTarget(const glm::vec3& v) { set(WANDER_TARGET_X, v); }
+
+	unsigned int getRandomState() const { return m_store->getRandomStates()[m_index]; }
+	void setRandomState(unsigned int state) { m_store->getRandomStates()[m_index] = state; }
+
+protected:
+
+	// a vector from three components in a row, starting with x
+	glm::vec3 get(eAgentComponent x) const {
+		return { m_store->get(x, m_index),
+				 m_store->get((eAgentComponent)(x + 1), m_index),
+				 m_store->get((eAgentComponent)(x + 2), m_index) };
+	}
+
+	void set(eAgentComponent x, const glm::vec3& v) {
+		m_store->set(x, m_index, v.x);
+		m_store->set((eAgentComponent)(x + 1), m_index, v.y);
+		m_store->set((eAgentComponent)(x + 2), m_index, v.z);
+	}
+
+	AgentStore*		m_store;
+	unsigned int	m_index;
+};
+
+inline AgentView AgentStore::getAgent(unsigned int index) {
+	return AgentView(this, index);
+}
+
+} // namespace ai
\ No newline at end of file
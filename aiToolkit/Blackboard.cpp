@@ -6,7 +6,7 @@ void Blackboard::clearData() {
 
 	for (auto data : m_data)
 		if (data.second.type == eBlackboardDataType::OWNEDPOINTER)
-			delete data.second.p;
+			data.second.deleter(data.second.p);
 
 	m_data.clear();
 }
@@ -108,6 +108,7 @@ public:
 			BlackboardData data;
 			data.type = own ? eBlackboardDataType::OWNEDPOINTER : eBlackboardDataType::POINTER;
 			data.p = value;
+			data.deleter = &deletePointer<T>;
 
 			m_data.insert(std::make_pair(name, data));
 		}
@@ -119,10 +120,11 @@ public:
 				return false;
 
 			if (iter->second.type == eBlackboardDataType::OWNEDPOINTER)
-				delete iter->second.p;
+				iter->second.deleter(iter->second.p);
 
 			iter->second.type = own ? eBlackboardDataType::OWNEDPOINTER : eBlackboardDataType::POINTER;
 			iter->second.p = value;
+			iter->second.deleter = &deletePointer<T>;
 		}
 
 		return true;
@@ -152,9 +154,16 @@ public:
 
 private:
 
+	// owned pointers are deleted as the type they were set with
+	template <typename T>
+	static void	deletePointer(void* p) { delete (T*)p; }
+
 	struct BlackboardData {
 		eBlackboardDataType type;
 
+		// only used by owned pointers
+		void (*deleter)(void*);
+
 		union {
 			float f;
 			int i;
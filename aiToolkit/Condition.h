@@ -65,7 +65,7 @@ public:
 
 	virtual bool test(Agent* entity) const {
 		// get target position
-		auto target = m_target->getPosition();
+		auto target = m_target->getSharedPosition();
 
 		// get my position
 		auto position = entity->getPosition();
@@ -0,0 +1,82 @@
+#include "CsrGraph.h"
+
+namespace graph {
+
+void CsrGraph::build(const std::vector<Node*>& nodes) {
+
+	clear();
+
+	unsigned int maxID = 0;
+	for (auto node : nodes)
+		maxID = node->getID() > maxID ? node->getID() : maxID;
+
+	m_indices.resize(nodes.empty() ? 0 : maxID + 1, INVALID_INDEX);
+
+	m_nodes = nodes;
+	m_version = nodes.empty() ? &GraphVersion::getDefault() : &nodes[0]->getGraphVersion();
+	m_flags.reserve(nodes.size());
+	m_offsets.reserve(nodes.size() + 1);
+
+	for (unsigned int i = 0; i < nodes.size(); ++i)
+		m_indices[nodes[i]->getID()] = i;
+
+	unsigned int edgeCount = 0;
+	for (auto node : nodes)
+		edgeCount += (unsigned int)node->edges.size();
+	m_edges.reserve(edgeCount);
+
+	// pack each node's edges one after the other
+	for (auto node : nodes) {
+
+		m_flags.push_back(node->flags);
+		m_offsets.push_back((unsigned int)m_edges.size());
+
+		for (auto edge : node->edges) {
+
+			unsigned int target = getIndex(edge->target);
+			if (target == INVALID_INDEX)
+				continue;
+
+			Edge packed = { target, edge->cost, edge->flags };
+			m_edges.push_back(packed);
+		}
+	}
+
+	m_offsets.push_back((unsigned int)m_edges.size());
+
+	// count the edges arriving at each node, then place them
+	m_incomingOffsets.assign(nodes.size() + 1, 0);
+	for (auto& edge : m_edges)
+		++m_incomingOffsets[edge.target + 1];
+	for (unsigned int i = 0; i < nodes.size(); ++i)
+		m_incomingOffsets[i + 1] += m_incomingOffsets[i];
+
+	std::vector<unsigned int> next(m_incomingOffsets.begin(), m_incomingOffsets.end() - 1);
+	m_incoming.resize(m_edges.size());
+
+	for (unsigned int i = 0; i < nodes.size(); ++i) {
+		for (auto edge = edgesBegin(i); edge != edgesEnd(i); ++edge) {
+			Edge incoming = { i, edge->cost, edge->flags };
+			m_incoming[next[edge->target]++] = incoming;
+		}
+	}
+}
+
+void CsrGraph::clear() {
+	m_nodes.clear();
+	m_flags.clear();
+	m_offsets.clear();
+	m_edges.clear();
+	m_incomingOffsets.clear();
+	m_incoming.clear();
+	m_indices.clear();
+	m_version = &GraphVersion::getDefault();
+}
+
+void CsrGraph::getNodePath(const std::vector<unsigned int>& indices, std::list<Node*>& path) const {
+	path.clear();
+	for (auto index : indices)
+		path.push_back(m_nodes[index]);
+}
+
+} // namespace graph
\ No newline at end of file
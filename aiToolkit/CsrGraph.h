@@ -0,0 +1,90 @@
+#pragma once
+
+#include "Pathfinding.h"
+
+namespace graph {
+
+// an immutable compressed-sparse-row copy of a Node graph.
+// Nodes are referred to by index [0, getNodeCount()) and the edges of
+// each node are packed together, so a search walks contiguous memory
+// rather than chasing individually allocated Node and Edge objects.
+// The edges arriving at each node are packed too, so that searches can
+// also run backwards from a goal.
+// Rebuild it if the source graph changes.
+class CsrGraph {
+public:
+
+	// a packed one-way edge. For incoming edges the target is the
+	// node the edge leaves from
+	struct Edge {
+		unsigned int target;
+		float cost;
+		unsigned int flags;
+	};
+
+	CsrGraph() : m_version(&GraphVersion::getDefault()) {}
+	~CsrGraph() {}
+
+	// builds from a collection of nodes, with each node's index being
+	// its position in the collection. Edges to nodes that are not in
+	// the collection are dropped
+	void build(const std::vector<Node*>& nodes);
+
+	template <typename T>
+	void build(const std::vector<T*>& nodes) {
+		build(std::vector<Node*>(nodes.begin(), nodes.end()));
+	}
+
+	void clear();
+
+	// the version of the graph the nodes were packed from
+	const GraphVersion& getGraphVersion() const { return *m_version; }
+
+	unsigned int getNodeCount() const { return (unsigned int)m_nodes.size(); }
+	unsigned int getEdgeCount() const { return (unsigned int)m_edges.size(); }
+
+	// the index of a source node, or INVALID_INDEX if it isn't in the graph
+	unsigned int getIndex(Node* node) const {
+		if (node == nullptr ||
+			node->getID() >= m_indices.size())
+			return INVALID_INDEX;
+		return m_indices[node->getID()];
+	}
+
+	// the source node that an index was built from
+	Node* getNode(unsigned int index) const { return m_nodes[index]; }
+
+	unsigned int getFlags(unsigned int index) const { return m_flags[index]; }
+
+	// the range of edges leaving a node
+	const Edge* edgesBegin(unsigned int index) const { return m_edges.data() + m_offsets[index]; }
+	const Edge* edgesEnd(unsigned int index) const { return m_edges.data() + m_offsets[index + 1]; }
+
+	// the range of edges arriving at a node
+	const Edge* incomingBegin(unsigned int index) const { return m_incoming.data() + m_incomingOffsets[index]; }
+	const Edge* incomingEnd(unsigned int index) const { return m_incoming.data() + m_incomingOffsets[index + 1]; }
+
+	// converts a path of indices back to the source nodes
+	void getNodePath(const std::vector<unsigned int>& indices, std::list<Node*>& path) const;
+
+protected:
+
+	// per node data
+	std::vector<Node*>			m_nodes;
+	std::vector<unsigned int>	m_flags;
+
+	// edges for node i are m_edges[m_offsets[i]] to m_edges[m_offsets[i + 1]]
+	std::vector<unsigned int>	m_offsets;
+	std::vector<Edge>			m_edges;
+
+	// the same edges grouped by the node they arrive at
+	std::vector<unsigned int>	m_incomingOffsets;
+	std::vector<Edge>			m_incoming;
+
+	// node ID to index lookup
+	std::vector<unsigned int>	m_indices;
+
+	const GraphVersion*			m_version;
+};
+
+} // namespace graph
\ No newline at end of file
@@ -0,0 +1,286 @@
+#include "DStarLite.h"
+
+#include <limits>
+#include <algorithm>
+
+namespace graph {
+
+static const float INFINITE_COST = std::numeric_limits<float>::infinity();
+
+DStarLite::DStarLite(unsigned int blockedFlags)
+	: m_blockedFlags(blockedFlags),
+	m_start(nullptr),
+	m_goal(nullptr),
+	m_last(nullptr),
+	m_keyModifier(0),
+	m_expandedCount(0) {
+}
+
+void DStarLite::initialise(const std::vector<Node*>& nodes, Node* start, Node* goal, Search::HeuristicCheck heuristic) {
+
+	m_heuristic = heuristic;
+	m_start = start;
+	m_goal = goal;
+	m_last = start;
+	m_keyModifier = 0;
+	m_expandedCount = 0;
+
+	unsigned int maxID = 0;
+	for (auto node : nodes)
+		maxID = node->getID() > maxID ? node->getID() : maxID;
+
+	unsigned int count = nodes.empty() ? 0 : maxID + 1;
+
+	m_nodes.assign(count, nullptr);
+	m_states.assign(count, State{ INFINITE_COST, INFINITE_COST, 0, 0, -1 });
+	m_incoming.assign(count, std::vector<Incoming>());
+	m_open.clear();
+
+	for (auto node : nodes)
+		m_nodes[node->getID()] = node;
+
+	// gather the edges into each node
+	for (auto node : nodes) {
+		for (auto edge : node->edges) {
+			if (isInGraph(edge->target)) {
+				Incoming incoming = { node, edge };
+				m_incoming[edge->target->getID()].push_back(incoming);
+			}
+		}
+	}
+
+	if (isInGraph(m_start) == false ||
+		isInGraph(m_goal) == false)
+		return;
+
+	// the search grows backwards out of the goal
+	m_states[m_goal->getID()].rhs = 0;
+	push(m_goal->getID());
+}
+
+void DStarLite::setStart(Node* start) {
+
+	if (isInGraph(start) == false ||
+		isInGraph(m_last) == false) {
+		m_start = start;
+		return;
+	}
+
+	// rather than re-keying the open list, raise the keys of anything
+	// added from now on by how far the start has moved
+	m_keyModifier += m_heuristic(m_last, start);
+	m_last = start;
+	m_start = start;
+}
+
+void DStarLite::updateEdge(Node* from, Edge* edge) {
+
+	if (isInGraph(from) == false ||
+		isInGraph(edge->target) == false)
+		return;
+
+	updateVertex(from->getID());
+}
+
+bool DStarLite::findPath(std::list<Node*>& path) {
+
+	path.clear();
+
+	m_expandedCount = 0;
+
+	if (isInGraph(m_start) == false ||
+		isInGraph(m_goal) == false ||
+		m_start == m_goal)
+		return false;
+
+	computeShortestPath();
+
+	if (m_states[m_start->getID()].g == INFINITE_COST)
+		return false;
+
+	// walk downhill from the start, which can't take more steps than
+	// there are nodes
+	Node* current = m_start;
+	path.push_back(current);
+
+	while (current != m_goal &&
+		   path.size() <= m_nodes.size()) {
+
+		Node* next = nullptr;
+		float best = INFINITE_COST;
+
+		for (auto edge : current->edges) {
+			if (isInGraph(edge->target) == false)
+				continue;
+
+			float cost = getCost(edge) + m_states[edge->target->getID()].g;
+			if (cost < best) {
+				best = cost;
+				next = edge->target;
+			}
+		}
+
+		if (next == nullptr) {
+			path.clear();
+			return false;
+		}
+
+		current = next;
+		path.push_back(current);
+	}
+
+	if (current != m_goal) {
+		path.clear();
+		return false;
+	}
+
+	return true;
+}
+
+float DStarLite::getCost(const Edge* edge) const {
+	return (edge->flags & m_blockedFlags) != 0 ? INFINITE_COST : edge->cost;
+}
+
+void DStarLite::calculateKey(unsigned int id, float& k1, float& k2) const {
+	auto& state = m_states[id];
+	k2 = std::min(state.g, state.rhs);
+	k1 = k2 + m_heuristic(m_start, m_nodes[id]) + m_keyModifier;
+}
+
+void DStarLite::updateVertex(unsigned int id) {
+
+	auto& state = m_states[id];
+
+	// the goal's cost is always 0
+	if (m_nodes[id] != m_goal) {
+		state.rhs = INFINITE_COST;
+		for (auto edge : m_nodes[id]->edges) {
+			if (isInGraph(edge->target)) {
+				float cost = getCost(edge) + m_states[edge->target->getID()].g;
+				state.rhs = std::min(state.rhs, cost);
+			}
+		}
+	}
+
+	if (state.heapIndex >= 0)
+		remove(id);
+
+	// only inconsistent nodes need expanding
+	if (state.g != state.rhs)
+		push(id);
+}
+
+void DStarLite::computeShortestPath() {
+
+	unsigned int start = m_start->getID();
+
+	while (m_open.empty() == false) {
+
+		unsigned int id = m_open.front();
+		auto& state = m_states[id];
+
+		float startK1, startK2;
+		calculateKey(start, startK1, startK2);
+
+		// done once nothing left could improve the start
+		if (isLess(state.k1, state.k2, startK1, startK2) == false &&
+			m_states[start].rhs == m_states[start].g)
+			break;
+
+		++m_expandedCount;
+
+		float k1, k2;
+		calculateKey(id, k1, k2);
+
+		if (isLess(state.k1, state.k2, k1, k2)) {
+			// the key is out of date since the start moved
+			remove(id);
+			push(id);
+		}
+		else if (state.g > state.rhs) {
+			// cost went down, pass it on to the nodes leading here
+			state.g = state.rhs;
+			remove(id);
+			for (auto& incoming : m_incoming[id])
+				updateVertex(incoming.from->getID());
+		}
+		else {
+			// cost went up, so it and anything leading here needs
+			// to find another way
+			state.g = INFINITE_COST;
+			updateVertex(id);
+			for (auto& incoming : m_incoming[id])
+				updateVertex(incoming.from->getID());
+		}
+	}
+}
+
+void DStarLite::push(unsigned int id) {
+	auto& state = m_states[id];
+	calculateKey(id, state.k1, state.k2);
+	state.heapIndex = (int)m_open.size();
+	m_open.push_back(id);
+	siftUp((int)m_open.size() - 1);
+}
+
+void DStarLite::remove(unsigned int id) {
+
+	int position = m_states[id].heapIndex;
+	m_states[id].heapIndex = -1;
+
+	unsigned int last = m_open.back();
+	m_open.pop_back();
+
+	if (last == id)
+		return;
+
+	m_open[position] = last;
+	m_states[last].heapIndex = position;
+
+	// the moved entry could belong either side of where it landed
+	siftUp(position);
+	siftDown(m_states[last].heapIndex);
+}
+
+void DStarLite::siftUp(int position) {
+	unsigned int id = m_open[position];
+	auto& state = m_states[id];
+	while (position > 0) {
+		int parent = (position - 1) / 2;
+		auto& parentState = m_states[m_open[parent]];
+		if (isLess(state.k1, state.k2, parentState.k1, parentState.k2) == false)
+			break;
+		m_open[position] = m_open[parent];
+		m_states[m_open[position]].heapIndex = position;
+		position = parent;
+	}
+	m_open[position] = id;
+	state.heapIndex = position;
+}
+
+void DStarLite::siftDown(int position) {
+	unsigned int id = m_open[position];
+	auto& state = m_states[id];
+	int count = (int)m_open.size();
+	while (true) {
+		int child = position * 2 + 1;
+		if (child >= count)
+			break;
+		if (child + 1 < count) {
+			auto& a = m_states[m_open[child + 1]];
+			auto& b = m_states[m_open[child]];
+			if (isLess(a.k1, a.k2, b.k1, b.k2))
+				++child;
+		}
+		auto& childState = m_states[m_open[child]];
+		if (isLess(childState.k1, childState.k2, state.k1, state.k2) == false)
+			break;
+		m_open[position] = m_open[child];
+		m_states[m_open[position]].heapIndex = position;
+		position = child;
+	}
+	m_open[position] = id;
+	state.heapIndex = position;
+}
+
+} // namespace graph
\ No newline at end of file
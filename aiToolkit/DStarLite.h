@@ -0,0 +1,108 @@
+#pragma once
+
+#include "Pathfinding.h"
+
+namespace graph {
+
+// an incremental search (D* Lite) to a fixed goal that keeps its search
+// data between queries. When edges change cost or flags, or the start
+// moves along the path, only the nodes whose costs are affected are
+// searched again rather than the whole graph.
+// The search runs backwards from the goal, so the incoming edges of each
+// node are gathered from the nodes given to initialise(); initialise()
+// again if edges are added or removed. Edges with any of the blocked
+// flags set are treated as impassable, and the heuristic must not
+// overestimate the cost between two nodes
+class DStarLite {
+public:
+
+	DStarLite(unsigned int blockedFlags = Edge::CLOSED);
+	~DStarLite() {}
+
+	// searches the graph made up of the nodes, edges to nodes that are
+	// not in the collection are ignored
+	void initialise(const std::vector<Node*>& nodes, Node* start, Node* goal, Search::HeuristicCheck heuristic);
+
+	template <typename T>
+	void initialise(const std::vector<T*>& nodes, Node* start, Node* goal, Search::HeuristicCheck heuristic) {
+		initialise(std::vector<Node*>(nodes.begin(), nodes.end()), start, goal, heuristic);
+	}
+
+	// moves the start, such as when the agent reaches the next node
+	void setStart(Node* start);
+
+	// call after changing the cost or flags of an edge leaving from
+	void updateEdge(Node* from, Edge* edge);
+
+	// brings the search up to date and returns the path from the start
+	// to the goal, or false if there isn't one
+	bool findPath(std::list<Node*>& path);
+
+	Node* getStart() const { return m_start; }
+	Node* getGoal() const { return m_goal; }
+
+	// how many nodes the last findPath() had to expand
+	unsigned int getExpandedCount() const { return m_expandedCount; }
+
+protected:
+
+	struct State {
+		// cost to the goal, and the one step lookahead of it
+		float g, rhs;
+
+		// open list priority, compared k1 first then k2
+		float k1, k2;
+
+		int heapIndex;
+	};
+
+	struct Incoming {
+		Node* from;
+		Edge* edge;
+	};
+
+	bool isInGraph(Node* node) const {
+		return node != nullptr &&
+			node->getID() < m_nodes.size() &&
+			m_nodes[node->getID()] == node;
+	}
+
+	float getCost(const Edge* edge) const;
+
+	void calculateKey(unsigned int id, float& k1, float& k2) const;
+	bool isLess(float a1, float a2, float b1, float b2) const {
+		return a1 < b1 || (a1 == b1 && a2 < b2);
+	}
+
+	void updateVertex(unsigned int id);
+	void computeShortestPath();
+
+	// binary min-heap open list over node IDs, with each state storing
+	// its position so entries can be updated or removed
+	void push(unsigned int id);
+	void remove(unsigned int id);
+	void siftUp(int position);
+	void siftDown(int position);
+
+	unsigned int	m_blockedFlags;
+
+	Search::HeuristicCheck	m_heuristic;
+
+	Node*	m_start;
+	Node*	m_goal;
+
+	// where the start was when the open list keys were last made valid
+	Node*	m_last;
+	float	m_keyModifier;
+
+	unsigned int	m_expandedCount;
+
+	// indexed by node ID
+	std::vector<Node*>					m_nodes;
+	std::vector<State>					m_states;
+	std::vector<std::vector<Incoming>>	m_incoming;
+
+	std::vector<unsigned int>	m_open;
+};
+
+} // namespace graph
\ No newline at end of file
@@ -0,0 +1,104 @@
+#include "DistanceMap.h"
+
+#include <algorithm>
+
+namespace graph {
+
+void DistanceMap::build(const std::vector<Node*>& sources) {
+
+	m_sources = sources;
+	m_graph = sources.empty() ? &GraphVersion::getDefault() : &sources[0]->getGraphVersion();
+	m_version = m_graph->get();
+
+	Search::dijkstraFlood(m_context, sources);
+}
+
+bool DistanceMap::getDistance(Node* node, float& distance) const {
+
+	float fScore;
+	Node* previous;
+	return m_context.getScores(node, distance, fScore, previous);
+}
+
+Node* DistanceMap::getSource(Node* node) const {
+
+	float gScore, fScore;
+	Node* previous = nullptr;
+
+	if (m_context.getScores(node, gScore, fScore, previous) == false)
+		return nullptr;
+
+	// walk back to where the search started
+	while (previous != nullptr) {
+		node = previous;
+		m_context.getScores(node, gScore, fScore, previous);
+	}
+
+	return node;
+}
+
+bool DistanceMap::getPath(Node* node, std::list<Node*>& path) const {
+
+	path.clear();
+
+	float gScore, fScore;
+	Node* previous = nullptr;
+
+	if (m_context.getScores(node, gScore, fScore, previous) == false)
+		return false;
+
+	while (node != nullptr) {
+		path.push_front(node);
+		m_context.getScores(node, gScore, fScore, node);
+	}
+
+	return true;
+}
+
+const DistanceMap& DistanceMapCache::get(const std::vector<Node*>& sources) {
+
+	std::vector<unsigned int> key;
+	for (auto node : sources)
+		key.push_back(node->getID());
+
+	std::sort(key.begin(), key.end());
+	key.erase(std::unique(key.begin(), key.end()), key.end());
+
+	++m_useCount;
+
+	for (auto& entry : m_entries) {
+		if (entry.key == key) {
+			entry.lastUsed = m_useCount;
+			if (entry.map->isCurrent() == false)
+				entry.map->build(sources);
+			return *entry.map;
+		}
+	}
+
+	// reuse the least recently used map once full
+	if (m_entries.size() >= m_maxMaps &&
+		m_entries.empty() == false) {
+
+		auto oldest = std::min_element(m_entries.begin(), m_entries.end(),
+									   [](const Entry& a, const Entry& b) { return a.lastUsed < b.lastUsed; });
+
+		oldest->key = key;
+		oldest->lastUsed = m_useCount;
+		oldest->map->build(sources);
+		return *oldest->map;
+	}
+
+	Entry entry = { key, new DistanceMap(), m_useCount };
+	entry.map->build(sources);
+	m_entries.push_back(entry);
+
+	return *entry.map;
+}
+
+void DistanceMapCache::clear() {
+	for (auto& entry : m_entries)
+		delete entry.map;
+	m_entries.clear();
+}
+
+} // namespace graph
\ No newline at end of file
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "Pathfinding.h"
+
+namespace graph {
+
+// the cost from the nearest of a set of source nodes to every node they
+// can reach, found with a single dijkstra search. Afterwards a distance
+// lookup is O(1) and a path lookup is O(path length), so questions like
+// "how far is the nearest medkit" can be answered for any number of
+// agents from one search
+class DistanceMap {
+public:
+
+	DistanceMap() : m_graph(nullptr), m_version(0) {}
+	~DistanceMap() {}
+
+	void build(const std::vector<Node*>& sources);
+
+	// false if the sources' graph has changed since the map was built
+	bool isCurrent() const { return m_graph != nullptr && m_version == m_graph->get(); }
+
+	const std::vector<Node*>& getSources() const { return m_sources; }
+
+	// the cost from the nearest source, false if no source reaches the node
+	bool getDistance(Node* node, float& distance) const;
+
+	// the source with the cheapest path to the node, or nullptr
+	Node* getSource(Node* node) const;
+
+	// the path from the nearest source to the node. When every edge has
+	// a matching edge back, as in the examples, the reverse of this is
+	// the path from the node to its nearest source
+	bool getPath(Node* node, std::list<Node*>& path) const;
+
+protected:
+
+	std::vector<Node*>	m_sources;
+	SearchContext		m_context;
+
+	// the sources' graph and its version when built, null if never built
+	const GraphVersion*	m_graph;
+	unsigned int		m_version;
+};
+
+// keeps the distance maps for the most recently used source sets,
+// rebuilding a map when its graph has changed since it was made.
+// Source sets are matched regardless of order
+class DistanceMapCache {
+public:
+
+	DistanceMapCache(unsigned int maxMaps = 8) : m_maxMaps(maxMaps), m_useCount(0) {}
+	~DistanceMapCache() { clear(); }
+
+	// owns the maps so can't be copied
+	DistanceMapCache(const DistanceMapCache&) = delete;
+	DistanceMapCache& operator = (const DistanceMapCache&) = delete;
+
+	// the up to date map for the sources, building it if needed.
+	// The reference is valid until the next call to get() or clear()
+	const DistanceMap& get(const std::vector<Node*>& sources);
+
+	void clear();
+
+	unsigned int getMapCount() const { return (unsigned int)m_entries.size(); }
+
+protected:
+
+	struct Entry {
+		// sorted source IDs
+		std::vector<unsigned int>	key;
+		DistanceMap*				map;
+		unsigned int				lastUsed;
+	};
+
+	unsigned int		m_maxMaps;
+	unsigned int		m_useCount;
+	std::vector<Entry>	m_entries;
+};
+
+} // namespace graph
\ No newline at end of file
@@ -0,0 +1,589 @@
+#include "FlowField.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(FLOWFIELD_AVX)
+#include <immintrin.h>
+#elif defined(FLOWFIELD_SSE)
+#include <emmintrin.h>
+#endif
+
+namespace ai {
+
+static const unsigned long long UNREACHED = ~0ull;
+
+void FlowField::create(int width, int height, unsigned short cost) {
+
+	m_width = width;
+	m_height = height;
+	m_maxIntegration = 0;
+
+	m_costs.assign(width * height, cost == 0 ? 1 : cost);
+	m_integration.assign(width * height, 0);
+	m_flow.assign(width * height, glm::vec3(0));
+}
+
+bool FlowField::integrate(int goalX, int goalY) {
+
+	if (isPassable(goalX, goalY) == false)
+		return false;
+
+	return integrate(std::vector<unsigned int>(1, (unsigned int)getIndex(goalX, goalY)));
+}
+
+bool FlowField::integrate(const std::vector<unsigned int>& goals) {
+
+	int stride = buildPadded();
+	unsigned int paddedCount = (unsigned int)m_padded.size();
+
+	m_distances.assign(paddedCount, UNREACHED);
+	m_maxIntegration = 0;
+
+	// the most expensive move is a diagonal into the costliest cell,
+	// so no cell is ever queued further ahead than that
+	unsigned short maxCost = 1;
+	for (auto cost : m_costs)
+		if (cost != IMPASSABLE)
+			maxCost = std::max(maxCost, cost);
+
+	unsigned int bucketCount = 3 * maxCost + 1;
+	if (m_buckets.size() < bucketCount)
+		m_buckets.resize(bucketCount);
+	for (auto& bucket : m_buckets)
+		bucket.clear();
+
+	size_t queued = 0;
+
+	for (auto goal : goals) {
+
+		if (goal >= (unsigned int)getCellCount())
+			continue;
+
+		unsigned int cell = (goal / m_width + 1) * stride + goal % m_width + 1;
+		if (m_padded[cell] != IMPASSABLE &&
+			m_distances[cell] != 0) {
+			m_distances[cell] = 0;
+			m_buckets[0].push_back(cell);
+			++queued;
+		}
+	}
+
+	bool found = queued > 0;
+
+	const unsigned short* costs = m_padded.data();
+	unsigned long long* distances = m_distances.data();
+
+	// cells are only expanded from the bucket of their final distance;
+	// if a cheaper route was found after a cell was queued it is expanded
+	// from the earlier bucket and the later entry is skipped. Expanded
+	// cells never improve so they don't need marking as closed
+	for (unsigned long long distance = 0; queued > 0; ++distance) {
+
+		auto& bucket = m_buckets[distance % bucketCount];
+
+		auto relax = [&](unsigned int neighbour, unsigned long long multiplier) {
+			unsigned long long cost = distance + costs[neighbour] * multiplier;
+			if (cost < distances[neighbour]) {
+				distances[neighbour] = cost;
+				m_buckets[cost % bucketCount].push_back(neighbour);
+				++queued;
+			}
+		};
+
+		// every move costs at least 2 and less than bucketCount half
+		// units, so cells are never added to the bucket being read
+		for (size_t i = 0; i < bucket.size(); ++i) {
+
+			unsigned int cell = bucket[i];
+			--queued;
+
+			if (distances[cell] != distance)
+				continue;
+
+			bool left = costs[cell - 1] != IMPASSABLE;
+			bool right = costs[cell + 1] != IMPASSABLE;
+			bool down = costs[cell - stride] != IMPASSABLE;
+			bool up = costs[cell + stride] != IMPASSABLE;
+
+			if (down) relax(cell - stride, 2);
+			if (up) relax(cell + stride, 2);
+			if (left) {
+				relax(cell - 1, 2);
+				if (down && costs[cell - stride - 1] != IMPASSABLE) relax(cell - stride - 1, 3);
+				if (up && costs[cell + stride - 1] != IMPASSABLE) relax(cell + stride - 1, 3);
+			}
+			if (right) {
+				relax(cell + 1, 2);
+				if (down && costs[cell - stride + 1] != IMPASSABLE) relax(cell - stride + 1, 3);
+				if (up && costs[cell + stride + 1] != IMPASSABLE) relax(cell + stride + 1, 3);
+			}
+		}
+
+		bucket.clear();
+	}
+
+	for (int y = 0; y < m_height; ++y) {
+		for (int x = 0; x < m_width; ++x) {
+
+			unsigned long long distance = distances[(y + 1) * stride + x + 1];
+			float& integration = m_integration[y * m_width + x];
+
+			if (distance == UNREACHED)
+				integration = UNREACHABLE_COST;
+			else {
+				integration = distance * 0.5f;
+				m_maxIntegration = std::max(m_maxIntegration, integration);
+			}
+		}
+	}
+
+	return found;
+}
+
+int FlowField::buildPadded() {
+
+	// the searches run over a copy of the costs with an impassable border,
+	// so neighbours are found by offset without checking the edges
+	int stride = m_width + 2;
+
+	m_padded.assign(stride * (m_height + 2), IMPASSABLE);
+	for (int y = 0; y < m_height; ++y)
+		std::copy_n(m_costs.begin() + y * m_width, m_width, m_padded.begin() + (y + 1) * stride + 1);
+
+	return stride;
+}
+
+bool FlowField::integrateEikonal(int goalX, int goalY) {
+
+	if (isPassable(goalX, goalY) == false)
+		return false;
+
+	return integrateEikonal(std::vector<unsigned int>(1, (unsigned int)getIndex(goalX, goalY)));
+}
+
+float FlowField::solveEikonal(unsigned int cell, int stride) const {
+
+	const float* times = m_times.data();
+
+	// the upwind neighbour along each axis
+	float a = std::min(times[cell - 1], times[cell + 1]);
+	float b = std::min(times[cell - stride], times[cell + stride]);
+	float cost = m_padded[cell];
+
+	if (a > b)
+		std::swap(a, b);
+
+	if (a == UNREACHABLE_COST)
+		return UNREACHABLE_COST;
+
+	// the front arrives along one axis only
+	if (b - a >= cost)
+		return a + cost;
+
+	// or from between both
+	return (a + b + std::sqrt(2 * cost * cost - (a - b) * (a - b))) * 0.5f;
+}
+
+bool FlowField::integrateEikonal(const std::vector<unsigned int>& goals) {
+
+	int stride = buildPadded();
+	unsigned int paddedCount = (unsigned int)m_padded.size();
+
+	const unsigned short* costs = m_padded.data();
+
+	m_times.assign(paddedCount, UNREACHABLE_COST);
+	m_isActive.assign(paddedCount, 0);
+	m_active.clear();
+	m_maxIntegration = 0;
+
+	float* times = m_times.data();
+	unsigned char* isActive = m_isActive.data();
+
+	const int offsets[4] = { -1, 1, -stride, stride };
+
+	bool found = false;
+
+	for (auto goal : goals) {
+
+		if (goal >= (unsigned int)getCellCount())
+			continue;
+
+		unsigned int cell = (goal / m_width + 1) * stride + goal % m_width + 1;
+		if (costs[cell] != IMPASSABLE) {
+			times[cell] = 0;
+			found = true;
+		}
+	}
+
+	// the scheme is least accurate beside a goal, where the front is
+	// sharply curved, so the cells around each goal start with their
+	// exact cost (unless another goal is closer)
+	const int rings[8][2] = { { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 }, { -1, -1 }, { 1, -1 }, { -1, 1 }, { 1, 1 } };
+	std::vector<unsigned int>& seeded = m_nextActive;
+	seeded.clear();
+
+	for (auto goal : goals) {
+
+		if (goal >= (unsigned int)getCellCount())
+			continue;
+
+		unsigned int cell = (goal / m_width + 1) * stride + goal % m_width + 1;
+		if (costs[cell] == IMPASSABLE)
+			continue;
+
+		seeded.push_back(cell);
+
+		for (auto& ring : rings) {
+
+			unsigned int neighbour = cell + ring[1] * stride + ring[0];
+			if (costs[neighbour] == IMPASSABLE)
+				continue;
+
+			// no cutting corners
+			bool diagonal = ring[0] != 0 && ring[1] != 0;
+			if (diagonal &&
+				(costs[cell + ring[0]] == IMPASSABLE ||
+				 costs[cell + ring[1] * stride] == IMPASSABLE))
+				continue;
+
+			float time = costs[neighbour] * (diagonal ? 1.41421356f : 1.0f);
+			if (time < times[neighbour]) {
+				times[neighbour] = time;
+				seeded.push_back(neighbour);
+			}
+		}
+	}
+
+	// the front starts from the cells next to those
+	for (auto cell : seeded) {
+		for (auto offset : offsets) {
+			unsigned int neighbour = cell + offset;
+			if (costs[neighbour] != IMPASSABLE &&
+				times[neighbour] == UNREACHABLE_COST &&
+				isActive[neighbour] == 0) {
+				isActive[neighbour] = 1;
+				m_active.push_back(neighbour);
+			}
+		}
+	}
+
+	while (m_active.empty() == false) {
+
+		// solve every active cell from the current times. No cell depends
+		// on another's new time so this loop can run in parallel
+		m_updates.resize(m_active.size());
+		for (size_t i = 0; i < m_active.size(); ++i)
+			m_updates[i] = solveEikonal(m_active[i], stride);
+
+		m_nextActive.clear();
+
+		for (size_t i = 0; i < m_active.size(); ++i) {
+
+			unsigned int cell = m_active[i];
+			float previous = times[cell];
+			float time = std::min(previous, m_updates[i]);
+			times[cell] = time;
+
+			// still changing, so solve it again next pass
+			if (previous - time > time * 1e-5f) {
+				m_nextActive.push_back(cell);
+				continue;
+			}
+
+			// converged, so wake any neighbour it would lower
+			isActive[cell] = 0;
+
+			for (auto offset : offsets) {
+
+				unsigned int neighbour = cell + offset;
+				if (costs[neighbour] == IMPASSABLE ||
+					isActive[neighbour] != 0)
+					continue;
+
+				float update = solveEikonal(neighbour, stride);
+				if (update < times[neighbour] - times[neighbour] * 1e-5f) {
+					times[neighbour] = update;
+					isActive[neighbour] = 1;
+					m_nextActive.push_back(neighbour);
+				}
+			}
+		}
+
+		m_active.swap(m_nextActive);
+	}
+
+	for (int y = 0; y < m_height; ++y) {
+		for (int x = 0; x < m_width; ++x) {
+
+			float time = times[(y + 1) * stride + x + 1];
+			m_integration[y * m_width + x] = time;
+
+			if (time != UNREACHABLE_COST)
+				m_maxIntegration = std::max(m_maxIntegration, time);
+		}
+	}
+
+	return found;
+}
+
+void FlowField::generateGradientFlow() {
+
+	for (int y = 0; y < m_height; ++y) {
+		for (int x = 0; x < m_width; ++x) {
+
+			int index = y * m_width + x;
+			float time = m_integration[index];
+
+			// cells outside of the field or that are impassable count as
+			// unreachable so the flow never points into them
+			auto sample = [&](int nx, int ny) {
+				return isPassable(nx, ny) ? m_integration[ny * m_width + nx] : UNREACHABLE_COST;
+			};
+
+			float left = sample(x - 1, y);
+			float right = sample(x + 1, y);
+			float down = sample(x, y - 1);
+			float up = sample(x, y + 1);
+
+			glm::vec3 flow(0);
+
+			if (m_costs[index] == IMPASSABLE ||
+				time == UNREACHABLE_COST) {
+
+				// flow out towards the cheapest neighbour
+				float lowest = std::min(std::min(left, right), std::min(down, up));
+				if (lowest != UNREACHABLE_COST) {
+					if (lowest == left) flow.x = -1;
+					else if (lowest == right) flow.x = 1;
+					else if (lowest == down) flow.y = -1;
+					else flow.y = 1;
+				}
+			}
+			else {
+
+				// downhill along each axis, towards the cheaper neighbour
+				if (left < right && left < time)
+					flow.x = left - time;
+				else if (right < time)
+					flow.x = time - right;
+
+				if (down < up && down < time)
+					flow.y = down - time;
+				else if (up < time)
+					flow.y = time - up;
+
+				float length = std::sqrt(flow.x * flow.x + flow.y * flow.y);
+				if (length > 0)
+					flow /= length;
+				else if (time > 0) {
+
+					// cells seeded diagonally from a goal can sit below both
+					// axis neighbours, so head straight for the cheaper corner
+					float lowest = time;
+					for (int dy = -1; dy <= 1; dy += 2) {
+						for (int dx = -1; dx <= 1; dx += 2) {
+							if (isPassable(x + dx, y) &&
+								isPassable(x, y + dy) &&
+								sample(x + dx, y + dy) < lowest) {
+								lowest = sample(x + dx, y + dy);
+								flow = glm::normalize(glm::vec3(dx, dy, 0));
+							}
+						}
+					}
+				}
+			}
+
+			m_flow[index] = flow;
+		}
+	}
+}
+
+void FlowField::padIntegrationRow(int row, int stride) {
+
+	// a border row above and below the field, and a border cell either
+	// side of each row. Impassable cells cost too much to move into
+	float* padded = m_paddedIntegration.data() + (row % 3) * stride;
+	std::fill_n(padded, stride, UNREACHABLE_COST);
+
+	if (row < 1 || row > m_height)
+		return;
+
+	const float* integration = m_integration.data() + (row - 1) * m_width;
+	const unsigned short* costs = m_costs.data() + (row - 1) * m_width;
+
+	for (int x = 0; x < m_width; ++x)
+		padded[x + 1] = costs[x] == IMPASSABLE ? UNREACHABLE_COST : integration[x];
+}
+
+void FlowField::generateFlow() {
+
+	const float diagonal = 0.70710678f;
+
+	// rows are long enough for the last vector of each row to run over the end
+	int stride = (m_width + FLOW_LANES - 1) / FLOW_LANES * FLOW_LANES + 2;
+
+	m_paddedIntegration.resize(stride * 3);
+	m_directions.resize(stride * 2);
+
+	padIntegrationRow(0, stride);
+	padIntegrationRow(1, stride);
+
+	// each cell points at its lowest neighbour if that is lower than
+	// the cell, trying them in the same order so ties go the same way.
+	// Impassable cells start from UNREACHABLE_COST so they flow out to the
+	// lowest neighbour, so agents pushed into them can find their way back.
+	// Diagonals need both cells beside them passable so as not to cut
+	// corners, and as a passable cell next to a reachable one is reachable
+	// too, a finite cost serves as the passable check.
+	// Whole rows are compared a vector at a time with the direction picked
+	// by masks, then copied into the flow
+	for (int y = 0; y < m_height; ++y) {
+
+		padIntegrationRow(y + 2, stride);
+
+		const float* below = m_paddedIntegration.data() + (y % 3) * stride + 1;
+		const float* centre = m_paddedIntegration.data() + ((y + 1) % 3) * stride + 1;
+		const float* above = m_paddedIntegration.data() + ((y + 2) % 3) * stride + 1;
+		float* flowX = m_directions.data();
+		float* flowY = flowX + stride;
+
+#if defined(FLOWFIELD_AVX)
+
+		const __m256 unreachable = _mm256_set1_ps(UNREACHABLE_COST);
+
+		// selects by and / andnot / or rather than blendv, which some
+		// compilers split into scalar code when AVX2 isn't enabled
+		auto select = [](__m256 a, __m256 b, __m256 mask) {
+			return _mm256_or_ps(_mm256_and_ps(mask, b), _mm256_andnot_ps(mask, a));
+		};
+
+		for (int x = 0; x < m_width; x += 8) {
+
+			__m256 lowest = _mm256_loadu_ps(centre + x);
+			__m256 dx = _mm256_setzero_ps();
+			__m256 dy = _mm256_setzero_ps();
+
+			__m256 down = _mm256_loadu_ps(below + x);
+			__m256 up = _mm256_loadu_ps(above + x);
+			__m256 left = _mm256_loadu_ps(centre + x - 1);
+			__m256 right = _mm256_loadu_ps(centre + x + 1);
+
+			__m256 downOpen = _mm256_cmp_ps(down, unreachable, _CMP_LT_OQ);
+			__m256 upOpen = _mm256_cmp_ps(up, unreachable, _CMP_LT_OQ);
+			__m256 leftOpen = _mm256_cmp_ps(left, unreachable, _CMP_LT_OQ);
+			__m256 rightOpen = _mm256_cmp_ps(right, unreachable, _CMP_LT_OQ);
+
+			auto sample = [&](__m256 cost, float dirX, float dirY) {
+				__m256 lower = _mm256_cmp_ps(cost, lowest, _CMP_LT_OQ);
+				lowest = select(lowest, cost, lower);
+				dx = select(dx, _mm256_set1_ps(dirX), lower);
+				dy = select(dy, _mm256_set1_ps(dirY), lower);
+			};
+			auto corner = [&](const float* row, int offset, __m256 open) {
+				return select(unreachable, _mm256_loadu_ps(row + x + offset), open);
+			};
+
+			sample(down, 0, -1);
+			sample(up, 0, 1);
+			sample(left, -1, 0);
+			sample(corner(below, -1, _mm256_and_ps(leftOpen, downOpen)), -diagonal, -diagonal);
+			sample(corner(above, -1, _mm256_and_ps(leftOpen, upOpen)), -diagonal, diagonal);
+			sample(right, 1, 0);
+			sample(corner(below, 1, _mm256_and_ps(rightOpen, downOpen)), diagonal, -diagonal);
+			sample(corner(above, 1, _mm256_and_ps(rightOpen, upOpen)), diagonal, diagonal);
+
+			_mm256_storeu_ps(flowX + x, dx);
+			_mm256_storeu_ps(flowY + x, dy);
+		}
+
+#elif defined(FLOWFIELD_SSE)
+
+		const __m128 unreachable = _mm_set1_ps(UNREACHABLE_COST);
+
+		// SSE2 has no blend, so selects are and / andnot / or
+		auto select = [](__m128 a, __m128 b, __m128 mask) {
+			return _mm_or_ps(_mm_and_ps(mask, b), _mm_andnot_ps(mask, a));
+		};
+
+		for (int x = 0; x < m_width; x += 4) {
+
+			__m128 lowest = _mm_loadu_ps(centre + x);
+			__m128 dx = _mm_setzero_ps();
+			__m128 dy = _mm_setzero_ps();
+
+			__m128 down = _mm_loadu_ps(below + x);
+			__m128 up = _mm_loadu_ps(above + x);
+			__m128 left = _mm_loadu_ps(centre + x - 1);
+			__m128 right = _mm_loadu_ps(centre + x + 1);
+
+			__m128 downOpen = _mm_cmplt_ps(down, unreachable);
+			__m128 upOpen = _mm_cmplt_ps(up, unreachable);
+			__m128 leftOpen = _mm_cmplt_ps(left, unreachable);
+			__m128 rightOpen = _mm_cmplt_ps(right, unreachable);
+
+			auto sample = [&](__m128 cost, float dirX, float dirY) {
+				__m128 lower = _mm_cmplt_ps(cost, lowest);
+				lowest = select(lowest, cost, lower);
+				dx = select(dx, _mm_set1_ps(dirX), lower);
+				dy = select(dy, _mm_set1_ps(dirY), lower);
+			};
+			auto corner = [&](const float* row, int offset, __m128 open) {
+				return select(unreachable, _mm_loadu_ps(row + x + offset), open);
+			};
+
+			sample(down, 0, -1);
+			sample(up, 0, 1);
+			sample(left, -1, 0);
+			sample(corner(below, -1, _mm_and_ps(leftOpen, downOpen)), -diagonal, -diagonal);
+			sample(corner(above, -1, _mm_and_ps(leftOpen, upOpen)), -diagonal, diagonal);
+			sample(right, 1, 0);
+			sample(corner(below, 1, _mm_and_ps(rightOpen, downOpen)), diagonal, -diagonal);
+			sample(corner(above, 1, _mm_and_ps(rightOpen, upOpen)), diagonal, diagonal);
+
+			_mm_storeu_ps(flowX + x, dx);
+			_mm_storeu_ps(flowY + x, dy);
+		}
+
+#else
+
+		for (int x = 0; x < m_width; ++x) {
+
+			float lowest = centre[x];
+			float dx = 0, dy = 0;
+
+			bool downOpen = below[x] < UNREACHABLE_COST;
+			bool upOpen = above[x] < UNREACHABLE_COST;
+			bool leftOpen = centre[x - 1] < UNREACHABLE_COST;
+			bool rightOpen = centre[x + 1] < UNREACHABLE_COST;
+
+			auto sample = [&](float cost, float dirX, float dirY) {
+				if (cost < lowest) {
+					lowest = cost;
+					dx = dirX;
+					dy = dirY;
+				}
+			};
+
+			sample(below[x], 0, -1);
+			sample(above[x], 0, 1);
+			sample(centre[x - 1], -1, 0);
+			if (leftOpen && downOpen) sample(below[x - 1], -diagonal, -diagonal);
+			if (leftOpen && upOpen) sample(above[x - 1], -diagonal, diagonal);
+			sample(centre[x + 1], 1, 0);
+			if (rightOpen && downOpen) sample(below[x + 1], diagonal, -diagonal);
+			if (rightOpen && upOpen) sample(above[x + 1], diagonal, diagonal);
+
+			flowX[x] = dx;
+			flowY[x] = dy;
+		}
+
+#endif
+
+		glm::vec3* flow = m_flow.data() + y * m_width;
+		for (int x = 0; x < m_width; ++x)
+			flow[x] = glm::vec3(flowX[x], flowY[x], 0);
+	}
+}
+
+} // namespace ai
\ No newline at end of file
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <cfloat>
+
+// generateFlow() compares 8 cells at a time with AVX, 4 with SSE2, or
+// one at a time where neither is available. Define FLOWFIELD_NO_SIMD to
+// always use the plain version
+#if !defined(FLOWFIELD_NO_SIMD)
+#if defined(__AVX__)
+#define FLOWFIELD_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FLOWFIELD_SSE
+#endif
+#endif
+
+namespace ai {
+
+// integration cost of cells that can't reach a goal
+const float UNREACHABLE_COST = FLT_MAX;
+
+// a flow field over a grid of movement costs. integrate() spreads the
+// cost of travelling to the goal out across the grid and generateFlow()
+// points each cell at its cheapest neighbour, so any number of agents
+// can head to the goal just by looking up the cell they are in.
+// Cells are indexed y * width + x. Moves are 8-connected without cutting
+// corners, entering a cell costs that cell's cost, and diagonal moves
+// cost half as much again
+class FlowField {
+public:
+
+	enum eCosts : unsigned short {
+		WALKABLE = 1,
+		IMPASSABLE = 0xffff,
+	};
+
+	FlowField() : m_width(0), m_height(0), m_maxIntegration(0) {}
+	FlowField(int width, int height, unsigned short cost = WALKABLE) { create(width, height, cost); }
+	~FlowField() {}
+
+	// sets every cell to cost and clears the integration and flow
+	void create(int width, int height, unsigned short cost = WALKABLE);
+
+	int getWidth() const { return m_width; }
+	int getHeight() const { return m_height; }
+	int getCellCount() const { return m_width * m_height; }
+
+	int getIndex(int x, int y) const { return y * m_width + x; }
+
+	bool isInside(int x, int y) const {
+		return x >= 0 && y >= 0 && x < m_width && y < m_height;
+	}
+
+	// cells outside of the field are impassable
+	unsigned short getCost(int x, int y) const {
+		return isInside(x, y) ? m_costs[y * m_width + x] : (unsigned short)IMPASSABLE;
+	}
+	bool isPassable(int x, int y) const { return getCost(x, y) != IMPASSABLE; }
+
+	// costs must be at least 1, or IMPASSABLE
+	void setCost(int x, int y, unsigned short cost) { m_costs[y * m_width + x] = cost == 0 ? 1 : cost; }
+
+	// finds the cost from every cell to the goal, returning false
+	// if the goal is impassable or off the field
+	bool integrate(int goalX, int goalY);
+
+	// as above but every cell finds the cost to its nearest goal,
+	// with goals given as cell indices
+	bool integrate(const std::vector<unsigned int>& goals);
+
+	// integrates by solving the eikonal equation |grad T| = cost with the
+	// Fast Iterative Method rather than by searching cell to cell, so the
+	// cost is that of moving in a straight line at any angle rather than
+	// only along the 8 directions. Together with generateGradientFlow()
+	// this gives smooth flow without the banding of 8 way flow. Each pass
+	// updates every active cell from the previous pass's costs only, so
+	// a pass can be split across threads
+	bool integrateEikonal(int goalX, int goalY);
+	bool integrateEikonal(const std::vector<unsigned int>& goals);
+
+	// the integrated cost to the goal, UNREACHABLE_COST if there's no route
+	float getIntegration(int x, int y) const { return m_integration[y * m_width + x]; }
+	const float* getIntegrationField() const { return m_integration.data(); }
+
+	// the highest integrated cost of any cell that can reach the goal
+	float getMaxIntegration() const { return m_maxIntegration; }
+
+	// points every cell at the neighbour with the lowest integrated cost,
+	// if it is lower than the cell's own. Goals and cells that can't
+	// reach a goal are left with no flow. Works a row at a time with SIMD
+	void generateFlow();
+
+	// points every cell down the slope of the integrated costs, found from
+	// the cheaper neighbour along each axis, so directions are continuous
+	// rather than one of 8. Best used after integrateEikonal()
+	void generateGradientFlow();
+
+	// unit length directions to move in, or 0 if there is nowhere better
+	const glm::vec3& getFlow(int x, int y) const { return m_flow[y * m_width + x]; }
+	glm::vec3* getFlowField() { return m_flow.data(); }
+	const glm::vec3* getFlowField() const { return m_flow.data(); }
+
+protected:
+
+	// fills m_padded from m_costs and returns its stride
+	int buildPadded();
+
+	// copies a row of m_integration into m_paddedIntegration, counting
+	// rows from the border above the field
+	void padIntegrationRow(int row, int stride);
+
+	// the eikonal solution for a padded cell from its neighbours' times
+	float solveEikonal(unsigned int cell, int stride) const;
+
+	int		m_width, m_height;
+
+	std::vector<unsigned short>	m_costs;
+	std::vector<float>			m_integration;
+	std::vector<glm::vec3>		m_flow;
+
+	float	m_maxIntegration;
+
+	// integration data kept between calls. Costs are counted in half
+	// units so that diagonal moves are whole numbers, which lets the
+	// search use a bucket queue (Dial's algorithm) with a bucket for each
+	// distance up to the largest move, rather than a binary heap.
+	// It suits small costs, as it steps through every distance in turn.
+	// These are indexed with a border of 1 cell around the field
+	std::vector<unsigned short>				m_padded;
+	std::vector<unsigned long long>			m_distances;
+	std::vector<std::vector<unsigned int>>	m_buckets;
+
+	// eikonal data, indexed with the same border. Active cells are listed
+	// with a flag per cell so none is listed twice
+	std::vector<float>			m_times;
+	std::vector<float>			m_updates;
+	std::vector<unsigned int>	m_active;
+	std::vector<unsigned int>	m_nextActive;
+	std::vector<unsigned char>	m_isActive;
+
+	// generateFlow() data. Only the 3 rows around the row being worked on
+	// are padded, so they stay in the cache. Rows are rounded up to a whole
+	// number of vectors, and impassable cells and the border are set to
+	// UNREACHABLE_COST. Directions are worked out a row at a time, all the
+	// x components then all the y
+	enum { FLOW_LANES = 8 };
+
+	std::vector<float>	m_paddedIntegration;
+	std::vector<float>	m_directions;
+};
+
+} // namespace ai
\ No newline at end of file
@@ -0,0 +1,243 @@
+#include "FlowFieldCache.h"
+
+#include <algorithm>
+
+namespace ai {
+
+FlowFieldCache::FlowFieldCache(unsigned int capacity)
+	: m_capacity(capacity),
+	m_version(0),
+	m_clock(0),
+	m_eikonal(false) {
+}
+
+FlowFieldCache::~FlowFieldCache() {
+	for (auto& entry : m_entries)
+		delete entry.field;
+}
+
+void FlowFieldCache::create(int width, int height, unsigned short cost) {
+
+	m_costs.create(width, height, cost);
+	++m_version;
+
+	evict(0);
+}
+
+void FlowFieldCache::setCost(int x, int y, unsigned short cost) {
+
+	m_costs.setCost(x, y, cost);
+	++m_version;
+}
+
+void FlowFieldCache::setCosts(const FlowField& costs) {
+
+	bool resized = costs.getWidth() != m_costs.getWidth() ||
+		costs.getHeight() != m_costs.getHeight();
+
+	m_costs = costs;
+	++m_version;
+
+	// goal cells are indices so mean something else at a new size
+	if (resized)
+		evict(0);
+}
+
+void FlowFieldCache::setEikonal(bool eikonal) {
+
+	if (m_eikonal != eikonal) {
+		m_eikonal = eikonal;
+		++m_version;
+	}
+}
+
+void FlowFieldCache::setCapacity(unsigned int capacity) {
+
+	m_capacity = capacity;
+	evict(capacity);
+}
+
+FlowFieldCache::Handle FlowFieldCache::acquire(int goalX, int goalY) {
+
+	if (isInside(goalX, goalY) == false)
+		return INVALID_HANDLE;
+
+	return acquire(std::vector<unsigned int>(1, (unsigned int)m_costs.getIndex(goalX, goalY)));
+}
+
+FlowFieldCache::Handle FlowFieldCache::acquire(const std::vector<unsigned int>& goals) {
+
+	// the same goals in any order share a field
+	std::vector<unsigned int> key;
+	key.reserve(goals.size());
+
+	for (auto goal : goals) {
+		if (goal < (unsigned int)m_costs.getCellCount() &&
+			m_costs.isPassable(goal % getWidth(), goal / getWidth()))
+			key.push_back(goal);
+	}
+
+	if (key.empty())
+		return INVALID_HANDLE;
+
+	std::sort(key.begin(), key.end());
+	key.erase(std::unique(key.begin(), key.end()), key.end());
+
+	auto iter = m_lookup.find(key);
+	if (iter != m_lookup.end()) {
+
+		Entry& entry = m_entries[iter->second - 1];
+		++entry.references;
+		entry.lastUsed = ++m_clock;
+
+		return iter->second;
+	}
+
+	// make room, then take a free entry or add one
+	evict(m_capacity > 0 ? m_capacity - 1 : 0);
+
+	Handle handle = INVALID_HANDLE;
+	for (unsigned int i = 0; i < m_entries.size(); ++i) {
+		if (m_entries[i].goals.empty()) {
+			handle = i + 1;
+			break;
+		}
+	}
+
+	if (handle == INVALID_HANDLE) {
+
+		Entry entry;
+		entry.field = new FlowField();
+		entry.references = 0;
+		entry.lastUsed = 0;
+		entry.version = 0;
+
+		m_entries.push_back(entry);
+		handle = (Handle)m_entries.size();
+	}
+
+	Entry& entry = m_entries[handle - 1];
+	entry.goals = key;
+	entry.references = 1;
+	entry.lastUsed = ++m_clock;
+
+	integrate(entry);
+
+	m_lookup[key] = handle;
+
+	return handle;
+}
+
+void FlowFieldCache::retain(Handle handle) {
+
+	Entry* entry = getEntry(handle);
+	if (entry != nullptr)
+		++entry->references;
+}
+
+void FlowFieldCache::release(Handle handle) {
+
+	Entry* entry = getEntry(handle);
+	if (entry != nullptr) {
+		--entry->references;
+
+		// may now be past capacity
+		evict(m_capacity);
+	}
+}
+
+unsigned int FlowFieldCache::getReferenceCount(Handle handle) const {
+
+	const Entry* entry = getEntry(handle);
+	return entry == nullptr ? 0 : entry->references;
+}
+
+const FlowField* FlowFieldCache::getField(Handle handle) {
+
+	Entry* entry = getEntry(handle);
+	if (entry == nullptr)
+		return nullptr;
+
+	entry->lastUsed = ++m_clock;
+
+	if (entry->version != m_version)
+		integrate(*entry);
+
+	return entry->field;
+}
+
+const glm::vec3& FlowFieldCache::getFlow(Handle handle, int x, int y) {
+
+	static const glm::vec3 none(0);
+
+	const FlowField* field = getField(handle);
+	if (field == nullptr ||
+		field->isInside(x, y) == false)
+		return none;
+
+	return field->getFlow(x, y);
+}
+
+FlowFieldCache::Entry* FlowFieldCache::getEntry(Handle handle) {
+
+	if (handle == INVALID_HANDLE ||
+		handle > m_entries.size() ||
+		m_entries[handle - 1].references == 0)
+		return nullptr;
+
+	return &m_entries[handle - 1];
+}
+
+const FlowFieldCache::Entry* FlowFieldCache::getEntry(Handle handle) const {
+
+	if (handle == INVALID_HANDLE ||
+		handle > m_entries.size() ||
+		m_entries[handle - 1].references == 0)
+		return nullptr;
+
+	return &m_entries[handle - 1];
+}
+
+void FlowFieldCache::integrate(Entry& entry) {
+
+	// copying the costs brings the size across too, so
+	// the flow and integration are sized to match
+	*entry.field = m_costs;
+	entry.version = m_version;
+
+	if (m_eikonal) {
+		entry.field->integrateEikonal(entry.goals);
+		entry.field->generateGradientFlow();
+	}
+	else {
+		entry.field->integrate(entry.goals);
+		entry.field->generateFlow();
+	}
+}
+
+void FlowFieldCache::evict(unsigned int count) {
+
+	while (m_lookup.size() > count) {
+
+		Entry* oldest = nullptr;
+
+		for (auto& entry : m_entries) {
+			if (entry.goals.empty() == false &&
+				entry.references == 0 &&
+				(oldest == nullptr || entry.lastUsed < oldest->lastUsed))
+				oldest = &entry;
+		}
+
+		// everything left is in use
+		if (oldest == nullptr)
+			break;
+
+		m_lookup.erase(oldest->goals);
+		oldest->goals.clear();
+
+		// frees the field's memory, keeping the entry to reuse
+		*oldest->field = FlowField();
+	}
+}
+
+} // namespace ai
\ No newline at end of file
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "FlowField.h"
+#include <map>
+
+namespace ai {
+
+// flow fields over one grid of costs, shared by goal. Fields are found
+// by their goal cell, or set of goal cells, so any number of agents
+// heading for the same goal use the same field and it is only integrated
+// once. acquire() hands out a handle and counts a reference to the field,
+// release() gives it up. Fields nothing references are kept in case the
+// goal is used again, until the cache is over capacity and they are the
+// least recently used. Fields that are referenced are never evicted, so
+// the capacity can be passed while they are all in use.
+// Changing the costs only marks the fields as out of date; each is
+// integrated again the next time it is used
+class FlowFieldCache {
+public:
+
+	typedef unsigned int Handle;
+
+	enum : Handle {
+		INVALID_HANDLE = 0,
+	};
+
+	enum {
+		DEFAULT_CAPACITY = 16,
+	};
+
+	FlowFieldCache(unsigned int capacity = DEFAULT_CAPACITY);
+	~FlowFieldCache();
+
+	// owns its fields so can't be copied
+	FlowFieldCache(const FlowFieldCache&) = delete;
+	FlowFieldCache& operator = (const FlowFieldCache&) = delete;
+
+	// sets every cell to cost, discarding the fields that aren't referenced.
+	// Fields still referenced keep their goals' cell indices
+	void create(int width, int height, unsigned short cost = FlowField::WALKABLE);
+
+	int getWidth() const { return m_costs.getWidth(); }
+	int getHeight() const { return m_costs.getHeight(); }
+
+	unsigned short getCost(int x, int y) const { return m_costs.getCost(x, y); }
+	bool isPassable(int x, int y) const { return m_costs.isPassable(x, y); }
+	bool isInside(int x, int y) const { return m_costs.isInside(x, y); }
+
+	void setCost(int x, int y, unsigned short cost);
+
+	// copies the size and costs of another field, discarding the fields
+	// that aren't referenced if the size changes
+	void setCosts(const FlowField& costs);
+
+	// integrate with FlowField::integrateEikonal() and generateGradientFlow()
+	// rather than FlowField::integrate() and generateFlow()
+	void setEikonal(bool eikonal);
+	bool isEikonal() const { return m_eikonal; }
+
+	void setCapacity(unsigned int capacity);
+	unsigned int getCapacity() const { return m_capacity; }
+
+	// fields held, whether referenced or not
+	unsigned int getFieldCount() const { return (unsigned int)m_lookup.size(); }
+
+	// a field towards a goal cell, or the nearest of a set of goals given
+	// as cell indices, integrating it if it isn't cached. Impassable goals
+	// are ignored, and INVALID_HANDLE is returned if there are none left
+	Handle acquire(int goalX, int goalY);
+	Handle acquire(const std::vector<unsigned int>& goals);
+
+	// counts another reference to a field already acquired
+	void retain(Handle handle);
+
+	// gives up a reference. The field stays cached until it is evicted
+	void release(Handle handle);
+
+	unsigned int getReferenceCount(Handle handle) const;
+
+	// the field for a handle, brought up to date with the costs.
+	// Null if the handle isn't referenced
+	const FlowField* getField(Handle handle);
+
+	// the flow from a cell, 0 if it is off the field or the handle isn't referenced
+	const glm::vec3& getFlow(Handle handle, int x, int y);
+
+protected:
+
+	struct Entry {
+		FlowField*					field;
+		std::vector<unsigned int>	goals;
+		unsigned int				references;
+		unsigned int				lastUsed;
+		unsigned int				version;	// of the costs it was integrated with
+	};
+
+	Entry* getEntry(Handle handle);
+	const Entry* getEntry(Handle handle) const;
+
+	// copies the costs to a field if they have changed and integrates it
+	void integrate(Entry& entry);
+
+	// drops unreferenced fields, least recently used first, until
+	// there are no more than count
+	void evict(unsigned int count);
+
+	FlowField	m_costs;
+
+	// handles are an index into the entries plus 1, and entries are
+	// only reused once nothing references them
+	std::vector<Entry>								m_entries;
+	std::map<std::vector<unsigned int>, Handle>		m_lookup;
+
+	unsigned int	m_capacity;
+	unsigned int	m_version;
+	unsigned int	m_clock;
+	bool			m_eikonal;
+};
+
+} // namespace ai
\ No newline at end of file
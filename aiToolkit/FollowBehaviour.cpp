@@ -18,7 +18,7 @@ eBehaviourResult FollowBehaviour::execute(Agent* entity) {
 		return eBehaviourResult::FAILURE;
 
 	// get target position
-	auto target = m_target->getPosition();
+	auto target = m_target->getSharedPosition();
 	
 	// get my position
 	auto position = entity->getPosition();
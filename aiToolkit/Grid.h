@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Pathfinding.h"
+
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <cstdlib>
+
+namespace graph {
+
+// a walkability bitmap for uniform-cost grid searches such as
+// Search::jumpPointSearch. Cells are indexed y * width + x
+class Grid {
+public:
+
+	Grid() : m_width(0), m_height(0) {}
+	Grid(int width, int height, bool walkable = false) { create(width, height, walkable); }
+	~Grid() {}
+
+	void create(int width, int height, bool walkable = false) {
+		m_width = width;
+		m_height = height;
+		m_cells.assign(width * height, walkable ? 1 : 0);
+		m_version.markChanged();
+	}
+
+	// fills the grid by querying each cell, e.g. a tile map
+	void create(int width, int height, std::function<bool(int x, int y)> isWalkable) {
+		create(width, height);
+		for (int y = 0; y < height; ++y)
+			for (int x = 0; x < width; ++x)
+				m_cells[y * width + x] = isWalkable(x, y) ? 1 : 0;
+	}
+
+	int getWidth() const { return m_width; }
+	int getHeight() const { return m_height; }
+	int getCellCount() const { return m_width * m_height; }
+
+	int getIndex(int x, int y) const { return y * m_width + x; }
+
+	bool isInside(int x, int y) const {
+		return x >= 0 && y >= 0 && x < m_width && y < m_height;
+	}
+
+	// cells outside of the grid are never walkable
+	bool isWalkable(int x, int y) const {
+		return isInside(x, y) && m_cells[y * m_width + x] != 0;
+	}
+
+	// bumps the grid's version so cached paths are dropped
+	void setWalkable(int x, int y, bool walkable) {
+		m_cells[y * m_width + x] = walkable ? 1 : 0;
+		m_version.markChanged();
+	}
+
+	// changes whenever the grid does, separately from any other graph
+	const GraphVersion& getVersion() const { return m_version; }
+
+	// the cost of moving between two cells along straight and diagonal
+	// lines, with horizontal and vertical steps costing 1
+	static float octileDistance(int x0, int y0, int x1, int y1) {
+		int dx = std::abs(x1 - x0);
+		int dy = std::abs(y1 - y0);
+		return (float)std::max(dx, dy) + (1.41421356f - 1) * std::min(dx, dy);
+	}
+
+protected:
+
+	int		m_width, m_height;
+
+	std::vector<unsigned char>	m_cells;
+
+	GraphVersion	m_version;
+};
+
+} // namespace graph
\ No newline at end of file
@@ -0,0 +1,128 @@
+#include "Heuristics.h"
+
+#include <limits>
+#include <algorithm>
+
+namespace graph {
+
+static const float UNREACHABLE = std::numeric_limits<float>::infinity();
+
+void LandmarkHeuristic::build(const CsrGraph& graph, unsigned int landmarkCount) {
+
+	unsigned int nodeCount = graph.getNodeCount();
+
+	m_landmarkCount = std::min(landmarkCount, nodeCount);
+	m_landmarks.clear();
+	m_from.assign(nodeCount * m_landmarkCount, UNREACHABLE);
+	m_to.assign(nodeCount * m_landmarkCount, UNREACHABLE);
+	m_graph = &graph.getGraphVersion();
+	m_version = m_graph->get();
+
+	if (m_landmarkCount == 0)
+		return;
+
+	SearchContext context;
+	float gScore, fScore;
+	unsigned int previous;
+
+	// the cost from the nearest landmark to each node, the next landmark
+	// is the node furthest from all of them. Nodes no landmark reaches
+	// count as furthest so that each part of the graph gets one
+	std::vector<float> nearest(nodeCount, UNREACHABLE);
+
+	// start furthest from an arbitrary node rather than at it
+	Search::dijkstraFlood(graph, context, { 0 });
+	unsigned int next = 0;
+	float furthest = 0;
+	for (unsigned int i = 0; i < nodeCount; ++i) {
+		if (context.getScores(i, gScore, fScore, previous) &&
+			gScore > furthest) {
+			furthest = gScore;
+			next = i;
+		}
+	}
+
+	for (unsigned int l = 0; l < m_landmarkCount; ++l) {
+
+		m_landmarks.push_back(next);
+
+		Search::dijkstraFlood(graph, context, { next });
+		for (unsigned int i = 0; i < nodeCount; ++i) {
+			if (context.getScores(i, gScore, fScore, previous)) {
+				m_from[i * m_landmarkCount + l] = gScore;
+				nearest[i] = std::min(nearest[i], gScore);
+			}
+		}
+
+		Search::dijkstraFlood(graph, context, { next }, true);
+		for (unsigned int i = 0; i < nodeCount; ++i)
+			if (context.getScores(i, gScore, fScore, previous))
+				m_to[i * m_landmarkCount + l] = gScore;
+
+		next = (unsigned int)(std::max_element(nearest.begin(), nearest.end()) - nearest.begin());
+	}
+}
+
+void LandmarkHeuristic::build(const std::vector<Node*>& nodes, unsigned int landmarkCount) {
+
+	CsrGraph graph;
+	graph.build(nodes);
+
+	build(graph, landmarkCount);
+
+	if (m_landmarkCount == 0)
+		return;
+
+	// move each row from the node's index to its ID
+	unsigned int maxID = 0;
+	for (auto node : nodes)
+		maxID = std::max(maxID, node->getID());
+
+	std::vector<float> from((maxID + 1) * m_landmarkCount, UNREACHABLE);
+	std::vector<float> to((maxID + 1) * m_landmarkCount, UNREACHABLE);
+
+	for (unsigned int i = 0; i < graph.getNodeCount(); ++i) {
+		unsigned int id = graph.getNode(i)->getID();
+		std::copy_n(m_from.begin() + i * m_landmarkCount, m_landmarkCount, from.begin() + id * m_landmarkCount);
+		std::copy_n(m_to.begin() + i * m_landmarkCount, m_landmarkCount, to.begin() + id * m_landmarkCount);
+	}
+
+	m_from.swap(from);
+	m_to.swap(to);
+
+	for (auto& landmark : m_landmarks)
+		landmark = graph.getNode(landmark)->getID();
+}
+
+float LandmarkHeuristic::estimate(unsigned int a, unsigned int b) const {
+
+	size_t rows = m_landmarkCount == 0 ? 0 : m_from.size() / m_landmarkCount;
+	if (a >= rows ||
+		b >= rows)
+		return 0;
+
+	const float* fromA = m_from.data() + a * m_landmarkCount;
+	const float* fromB = m_from.data() + b * m_landmarkCount;
+	const float* toA = m_to.data() + a * m_landmarkCount;
+	const float* toB = m_to.data() + b * m_landmarkCount;
+
+	float best = 0;
+
+	for (unsigned int l = 0; l < m_landmarkCount; ++l) {
+
+		// a landmark that reaches neither (or that neither reaches) says
+		// nothing. If it reaches one but not the other the bound becomes
+		// infinite, which is right as b then can't be reached from a
+		if (fromA[l] != UNREACHABLE ||
+			fromB[l] != UNREACHABLE)
+			best = std::max(best, fromB[l] - fromA[l]);
+
+		if (toA[l] != UNREACHABLE ||
+			toB[l] != UNREACHABLE)
+			best = std::max(best, toA[l] - toB[l]);
+	}
+
+	return best;
+}
+
+} // namespace graph
\ No newline at end of file
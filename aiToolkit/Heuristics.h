@@ -0,0 +1,179 @@
+#pragma once
+
+#include "Pathfinding.h"
+#include "CsrGraph.h"
+
+#include <cmath>
+
+namespace graph {
+
+// common A* heuristics for nodes with a position.
+// A heuristic must never overestimate the cost of the cheapest path
+// (admissible) or A* can return longer paths than it needs to, and it
+// should never drop by more than the cost of an edge (consistent) or
+// nodes get expanded more than they need to be. Distances are both,
+// as long as no edge costs less than the distance it covers; squared
+// distances are neither.
+// The factories take a function returning the position of a node as
+// anything with an x and y, for example:
+//   Heuristics::euclidean([](Node* n) { return ((MyNode*)n)->position; })
+// and costPerUnit scales the distance if edges cost more or less than
+// their length. It must be the cheapest cost per unit of any edge
+class Heuristics {
+public:
+
+	// straight line distance, for any movement
+	static float euclidean(float dx, float dy) {
+		return std::sqrt(dx * dx + dy * dy);
+	}
+
+	// distance when moving only along the axes, for 4-connected grids
+	static float manhattan(float dx, float dy) {
+		return std::fabs(dx) + std::fabs(dy);
+	}
+
+	// distance when moving along the axes and diagonals, for 8-connected
+	// grids, where a diagonal step costs diagonalCost times a straight one
+	static float octile(float dx, float dy, float diagonalCost = 1.41421356f) {
+		dx = std::fabs(dx);
+		dy = std::fabs(dy);
+		return dx > dy ? dx + (diagonalCost - 1) * dy : dy + (diagonalCost - 1) * dx;
+	}
+
+	// the heuristics as function objects, which convert to a
+	// HeuristicCheck or can be given to the templated searches to be inlined
+	template <typename Position>
+	struct Euclidean {
+		Position position;
+		float costPerUnit;
+
+		float operator () (Node* a, Node* b) const {
+			const auto& pa = position(a);
+			const auto& pb = position(b);
+			return Heuristics::euclidean(pb.x - pa.x, pb.y - pa.y) * costPerUnit;
+		}
+	};
+
+	template <typename Position>
+	struct Manhattan {
+		Position position;
+		float costPerUnit;
+
+		float operator () (Node* a, Node* b) const {
+			const auto& pa = position(a);
+			const auto& pb = position(b);
+			return Heuristics::manhattan(pb.x - pa.x, pb.y - pa.y) * costPerUnit;
+		}
+	};
+
+	template <typename Position>
+	struct Octile {
+		Position position;
+		float costPerUnit;
+		float diagonalCost;
+
+		float operator () (Node* a, Node* b) const {
+			const auto& pa = position(a);
+			const auto& pb = position(b);
+			return Heuristics::octile(pb.x - pa.x, pb.y - pa.y, diagonalCost) * costPerUnit;
+		}
+	};
+
+	template <typename Position>
+	static Euclidean<Position> euclidean(Position position, float costPerUnit = 1) {
+		return Euclidean<Position>{ position, costPerUnit };
+	}
+
+	template <typename Position>
+	static Manhattan<Position> manhattan(Position position, float costPerUnit = 1) {
+		return Manhattan<Position>{ position, costPerUnit };
+	}
+
+	template <typename Position>
+	static Octile<Position> octile(Position position, float costPerUnit = 1, float diagonalCost = 1.41421356f) {
+		return Octile<Position>{ position, costPerUnit, diagonalCost };
+	}
+
+private:
+
+	Heuristics() {}
+};
+
+// the ALT heuristic (A*, landmarks and the triangle inequality), which
+// needs no positions at all. The exact costs to and from a few landmark
+// nodes are found once up front, then for any landmark L
+//   cost(a, b) >= cost(L, b) - cost(L, a)
+//   cost(a, b) >= cost(a, L) - cost(b, L)
+// and the best of these bounds is the estimate. It is admissible and
+// consistent, and around walls and other detours it is usually far
+// closer to the real cost than a straight line distance, so searches
+// expand fewer nodes. Landmarks are picked far from each other, which
+// tends to put them behind the nodes being searched between.
+// Memory is two floats per node per landmark. Rebuild it if edge costs
+// drop or edges are added, otherwise it can overestimate
+class LandmarkHeuristic {
+public:
+
+	LandmarkHeuristic() : m_landmarkCount(0), m_graph(nullptr), m_version(0) {}
+	~LandmarkHeuristic() {}
+
+	// finds the costs between landmarks and every node of the graph,
+	// which needs 2 dijkstra floods per landmark
+	void build(const CsrGraph& graph, unsigned int landmarkCount = 8);
+
+	// builds from a collection of nodes, packing them into a CsrGraph first
+	void build(const std::vector<Node*>& nodes, unsigned int landmarkCount = 8);
+
+	template <typename T>
+	void build(const std::vector<T*>& nodes, unsigned int landmarkCount = 8) {
+		build(std::vector<Node*>(nodes.begin(), nodes.end()), landmarkCount);
+	}
+
+	// false if the graph it was built from has changed since
+	bool isCurrent() const { return m_graph != nullptr && m_version == m_graph->get(); }
+
+	unsigned int getLandmarkCount() const { return m_landmarkCount; }
+
+	// the landmarks, as node IDs when built from nodes or CsrGraph indices
+	const std::vector<unsigned int>& getLandmarks() const { return m_landmarks; }
+
+	// the estimate between two CsrGraph indices (or node IDs if built from
+	// nodes). Infinite if b can't be reached from a
+	float estimate(unsigned int a, unsigned int b) const;
+
+	float estimate(Node* a, Node* b) const { return estimate(a->getID(), b->getID()); }
+
+	// heuristics for the searches, which refer to this so it must outlive
+	// them. getHeuristic() is for when it was built from nodes and
+	// getIndexHeuristic() for when it was built from a CsrGraph.
+	// Both can be stored as a HeuristicCheck or IndexHeuristicCheck
+	struct NodeEstimate {
+		const LandmarkHeuristic* landmarks;
+		float operator () (Node* a, Node* b) const { return landmarks->estimate(a->getID(), b->getID()); }
+	};
+
+	struct IndexEstimate {
+		const LandmarkHeuristic* landmarks;
+		float operator () (unsigned int a, unsigned int b) const { return landmarks->estimate(a, b); }
+	};
+
+	NodeEstimate getHeuristic() const { return NodeEstimate{ this }; }
+	IndexEstimate getIndexHeuristic() const { return IndexEstimate{ this }; }
+
+protected:
+
+	unsigned int	m_landmarkCount;
+
+	std::vector<unsigned int>	m_landmarks;
+
+	// costs from and to each landmark, landmarkCount per node, so an
+	// estimate only touches the two nodes' rows
+	std::vector<float>	m_from;
+	std::vector<float>	m_to;
+
+	// the graph and its version when built, null if never built
+	const GraphVersion*	m_graph;
+	unsigned int		m_version;
+};
+
+} // namespace graph
\ No newline at end of file
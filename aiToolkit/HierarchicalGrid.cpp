@@ -0,0 +1,394 @@
+#include "HierarchicalGrid.h"
+#include "SearchLoop.h"
+
+#include <algorithm>
+
+namespace graph {
+
+// lets the search loop walk the cells of a single cluster
+struct HierarchicalGrid::ClusterEdges {
+
+	const Grid& grid;
+	const Cluster& cluster;
+
+	template <typename Visit>
+	void forEach(Node*, unsigned int index, Visit visit) const {
+
+		int x = index % grid.getWidth();
+		int y = index / grid.getWidth();
+
+		for (int dy = -1; dy <= 1; ++dy) {
+			for (int dx = -1; dx <= 1; ++dx) {
+
+				int nx = x + dx;
+				int ny = y + dy;
+
+				if ((dx == 0 && dy == 0) ||
+					nx < cluster.minX || nx > cluster.maxX ||
+					ny < cluster.minY || ny > cluster.maxY ||
+					grid.isWalkable(nx, ny) == false)
+					continue;
+
+				// diagonals can't cut corners
+				if (dx != 0 && dy != 0 &&
+					(grid.isWalkable(x + dx, y) == false ||
+					 grid.isWalkable(x, y + dy) == false))
+					continue;
+
+				visit(grid.getIndex(nx, ny), nullptr, Grid::octileDistance(x, y, nx, ny));
+			}
+		}
+	}
+};
+
+// lets the search loop walk the entrances, with the start and goal
+// cells joined to the entrances of their clusters for this search only
+struct HierarchicalGrid::AbstractEdges {
+
+	const HierarchicalGrid& hierarchy;
+	unsigned int start, goal;
+	int goalCluster;
+	const std::vector<Link>& startLinks;
+	const std::vector<Link>& goalLinks;
+
+	template <typename Visit>
+	void forEach(Node*, unsigned int index, Visit visit) const {
+
+		if (index == start) {
+			for (auto& link : startLinks)
+				visit(link.target, nullptr, link.cost);
+		}
+
+		auto entrance = hierarchy.getEntrance(index);
+		if (entrance != nullptr) {
+			for (auto& link : entrance->links)
+				visit(link.target, nullptr, link.cost);
+		}
+
+		if (hierarchy.getClusterIndex(index) == goalCluster) {
+			for (auto& link : goalLinks) {
+				if (link.target == index)
+					visit(goal, nullptr, link.cost);
+			}
+		}
+	}
+};
+
+void HierarchicalGrid::build(const Grid& grid, SearchContext& context, int clusterSize) {
+
+	m_grid = &grid;
+	m_clusterSize = clusterSize;
+	m_clustersWide = (grid.getWidth() + clusterSize - 1) / clusterSize;
+	m_clustersHigh = (grid.getHeight() + clusterSize - 1) / clusterSize;
+
+	m_clusters.clear();
+	m_clusters.resize(m_clustersWide * m_clustersHigh);
+
+	for (int y = 0; y < m_clustersHigh; ++y) {
+		for (int x = 0; x < m_clustersWide; ++x) {
+			auto& cluster = m_clusters[y * m_clustersWide + x];
+			cluster.minX = x * clusterSize;
+			cluster.minY = y * clusterSize;
+			cluster.maxX = std::min(cluster.minX + clusterSize, grid.getWidth()) - 1;
+			cluster.maxY = std::min(cluster.minY + clusterSize, grid.getHeight()) - 1;
+		}
+	}
+
+	m_cellEntrances.assign(grid.getCellCount(), INVALID_INDEX);
+
+	for (int i = 0; i < (int)m_clusters.size(); ++i)
+		buildCluster(context, i);
+}
+
+void HierarchicalGrid::repair(SearchContext& context, int minX, int minY, int maxX, int maxY) {
+
+	if (m_grid == nullptr)
+		return;
+
+	// a change beside a border also moves the entrances of the
+	// cluster on the other side
+	minX = std::max(minX - 1, 0);
+	minY = std::max(minY - 1, 0);
+	maxX = std::min(maxX + 1, m_grid->getWidth() - 1);
+	maxY = std::min(maxY + 1, m_grid->getHeight() - 1);
+
+	for (int y = minY / m_clusterSize; y <= maxY / m_clusterSize; ++y)
+		for (int x = minX / m_clusterSize; x <= maxX / m_clusterSize; ++x)
+			buildCluster(context, y * m_clustersWide + x);
+}
+
+unsigned int HierarchicalGrid::getEntranceCount() const {
+	unsigned int count = 0;
+	for (auto& cluster : m_clusters)
+		count += (unsigned int)cluster.entrances.size();
+	return count;
+}
+
+int HierarchicalGrid::getClusterIndex(unsigned int cell) const {
+	int x = cell % m_grid->getWidth();
+	int y = cell / m_grid->getWidth();
+	return (y / m_clusterSize) * m_clustersWide + x / m_clusterSize;
+}
+
+const HierarchicalGrid::Entrance* HierarchicalGrid::getEntrance(unsigned int cell) const {
+	unsigned int index = m_cellEntrances[cell];
+	if (index == INVALID_INDEX)
+		return nullptr;
+	return &m_clusters[getClusterIndex(cell)].entrances[index];
+}
+
+void HierarchicalGrid::buildCluster(SearchContext& context, int index) {
+
+	auto& cluster = m_clusters[index];
+
+	for (auto& entrance : cluster.entrances)
+		m_cellEntrances[entrance.cell] = INVALID_INDEX;
+	cluster.entrances.clear();
+
+	// entrances on each side, where a cell in a corner can be an
+	// entrance to two neighbours
+	std::vector<std::pair<unsigned int, unsigned int>> transitions;
+	findTransitions(cluster, -1, 0, transitions);
+	findTransitions(cluster, 1, 0, transitions);
+	findTransitions(cluster, 0, -1, transitions);
+	findTransitions(cluster, 0, 1, transitions);
+
+	for (auto& transition : transitions) {
+
+		unsigned int entrance = m_cellEntrances[transition.first];
+		if (entrance == INVALID_INDEX) {
+			entrance = (unsigned int)cluster.entrances.size();
+			m_cellEntrances[transition.first] = entrance;
+			cluster.entrances.push_back(Entrance{ transition.first, {} });
+		}
+
+		Link link = { transition.second, 1 };
+		cluster.entrances[entrance].links.push_back(link);
+	}
+
+	// the cost of crossing the cluster between each pair of entrances
+	for (auto& entrance : cluster.entrances) {
+
+		searchCluster(context, entrance.cell);
+
+		for (auto& other : cluster.entrances) {
+
+			float gScore, fScore;
+			unsigned int previous;
+
+			if (&other != &entrance &&
+				context.getScores(other.cell, gScore, fScore, previous)) {
+				Link link = { other.cell, gScore };
+				entrance.links.push_back(link);
+			}
+		}
+	}
+}
+
+void HierarchicalGrid::findTransitions(const Cluster& cluster, int dx, int dy,
+									   std::vector<std::pair<unsigned int, unsigned int>>& transitions) const {
+
+	// the first cell along the side and the direction along it
+	int x = dx > 0 ? cluster.maxX : cluster.minX;
+	int y = dy > 0 ? cluster.maxY : cluster.minY;
+	int stepX = dx == 0 ? 1 : 0;
+	int stepY = dy == 0 ? 1 : 0;
+	int length = dx == 0 ? cluster.maxX - cluster.minX + 1 : cluster.maxY - cluster.minY + 1;
+
+	// the edge of the grid
+	if (m_grid->isInside(x + dx, y + dy) == false)
+		return;
+
+	auto add = [&](int i) {
+		int cx = x + stepX * i;
+		int cy = y + stepY * i;
+		transitions.push_back(std::make_pair(m_grid->getIndex(cx, cy), m_grid->getIndex(cx + dx, cy + dy)));
+	};
+
+	// both clusters scan the same stretch in the same order
+	// so they always agree on where the entrances are
+	int runStart = -1;
+	for (int i = 0; i <= length; ++i) {
+
+		bool open = i < length &&
+					m_grid->isWalkable(x + stepX * i, y + stepY * i) &&
+					m_grid->isWalkable(x + stepX * i + dx, y + stepY * i + dy);
+
+		if (open && runStart < 0) {
+			runStart = i;
+		}
+		else if (open == false && runStart >= 0) {
+			int runLength = i - runStart;
+			if (runLength < LONG_ENTRANCE_LENGTH) {
+				add(runStart + runLength / 2);
+			}
+			else {
+				add(runStart);
+				add(i - 1);
+			}
+			runStart = -1;
+		}
+	}
+}
+
+void HierarchicalGrid::searchCluster(SearchContext& context, unsigned int cell) const {
+
+	context.begin(m_grid->getCellCount());
+
+	// never finds a goal so it spreads over the whole cluster
+	Search::search(context, ClusterEdges{ *m_grid, m_clusters[getClusterIndex(cell)] }, cell, nullptr,
+				   [](unsigned int, Node*) { return false; },
+				   [](unsigned int, Node*) { return 0.0f; });
+}
+
+void HierarchicalGrid::connect(SearchContext& context, unsigned int cell, unsigned int goal, std::vector<Link>& links) const {
+
+	searchCluster(context, cell);
+
+	float gScore, fScore;
+	unsigned int previous;
+
+	for (auto& entrance : m_clusters[getClusterIndex(cell)].entrances) {
+		if (entrance.cell != cell &&
+			context.getScores(entrance.cell, gScore, fScore, previous)) {
+			Link link = { entrance.cell, gScore };
+			links.push_back(link);
+		}
+	}
+
+	if (goal != INVALID_INDEX &&
+		goal != cell &&
+		getClusterIndex(goal) == getClusterIndex(cell) &&
+		context.getScores(goal, gScore, fScore, previous)) {
+		Link link = { goal, gScore };
+		links.push_back(link);
+	}
+}
+
+bool HierarchicalGrid::findAbstractPath(SearchContext& context,
+										int startX, int startY, int endX, int endY,
+										std::vector<unsigned int>& waypoints) const {
+
+	waypoints.clear();
+
+	if (m_grid == nullptr ||
+		m_grid->isWalkable(startX, startY) == false ||
+		m_grid->isWalkable(endX, endY) == false)
+		return false;
+
+	unsigned int start = m_grid->getIndex(startX, startY);
+	unsigned int goal = m_grid->getIndex(endX, endY);
+
+	if (start == goal)
+		return false;
+
+	std::vector<Link> startLinks, goalLinks;
+	connect(context, start, goal, startLinks);
+	connect(context, goal, INVALID_INDEX, goalLinks);
+
+	context.begin(m_grid->getCellCount());
+
+	int width = m_grid->getWidth();
+
+	unsigned int found = Search::search(context, AbstractEdges{ *this, start, goal, getClusterIndex(goal), startLinks, goalLinks },
+										start, nullptr,
+										[goal](unsigned int n, Node*) { return n == goal; },
+										[width, endX, endY](unsigned int n, Node*) {
+											return Grid::octileDistance(n % width, n / width, endX, endY);
+										});
+
+	if (found == INVALID_INDEX)
+		return false;
+
+	float gScore, fScore;
+	unsigned int index = found;
+	while (index != INVALID_INDEX) {
+		waypoints.push_back(index);
+		context.getScores(index, gScore, fScore, index);
+	}
+
+	std::reverse(waypoints.begin(), waypoints.end());
+
+	return true;
+}
+
+bool HierarchicalGrid::refineSegment(SearchContext& context, unsigned int from, unsigned int to,
+									 std::vector<unsigned int>& cells) const {
+
+	// a single step across a border
+	if (getClusterIndex(from) != getClusterIndex(to)) {
+		cells.push_back(to);
+		return true;
+	}
+
+	context.begin(m_grid->getCellCount());
+
+	int width = m_grid->getWidth();
+	int endX = to % width;
+	int endY = to / width;
+
+	unsigned int found = Search::search(context, ClusterEdges{ *m_grid, m_clusters[getClusterIndex(from)] }, from, nullptr,
+										[to](unsigned int n, Node*) { return n == to; },
+										[width, endX, endY](unsigned int n, Node*) {
+											return Grid::octileDistance(n % width, n / width, endX, endY);
+										});
+
+	if (found == INVALID_INDEX)
+		return false;
+
+	size_t first = cells.size();
+
+	float gScore, fScore;
+	unsigned int index = to;
+	while (index != from) {
+		cells.push_back(index);
+		context.getScores(index, gScore, fScore, index);
+	}
+
+	std::reverse(cells.begin() + first, cells.end());
+
+	return true;
+}
+
+bool HierarchicalGrid::findPath(SearchContext& context,
+								int startX, int startY, int endX, int endY,
+								std::vector<unsigned int>& path) const {
+
+	path.clear();
+
+	std::vector<unsigned int> waypoints;
+	if (findAbstractPath(context, startX, startY, endX, endY, waypoints) == false)
+		return false;
+
+	path.push_back(waypoints.front());
+	for (size_t i = 1; i < waypoints.size(); ++i) {
+		if (refineSegment(context, waypoints[i - 1], waypoints[i], path) == false) {
+			path.clear();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool HierarchicalGrid::findPath(SearchContext& context,
+								int startX, int startY, int endX, int endY,
+								const std::vector<Node*>& cellNodes, Path& path) const {
+
+	path.clear();
+
+	if (m_grid == nullptr ||
+		cellNodes.size() < (size_t)m_grid->getCellCount())
+		return false;
+
+	std::vector<unsigned int> cells;
+	if (findPath(context, startX, startY, endX, endY, cells) == false)
+		return false;
+
+	for (auto cell : cells)
+		path.pushBack(cellNodes[cell]);
+
+	return true;
+}
+
+} // namespace graph
\ No newline at end of file
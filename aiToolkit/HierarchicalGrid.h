@@ -0,0 +1,113 @@
+#pragma once
+
+#include "Pathfinding.h"
+#include "Grid.h"
+
+namespace graph {
+
+// a two level abstraction of a Grid for long searches (HPA*).
+// The grid is split into square clusters and entrances are placed along
+// the open stretches of each border between clusters, with the costs of
+// crossing a cluster between its entrances found up front. A search then
+// only walks entrances, and the cells between each pair of waypoints can
+// be filled in as they are needed with a small search inside one cluster.
+// Paths are close to but not always optimal.
+// Movement matches Search::jumpPointSearch: 8-connected, octile costs
+// and no cutting corners. Queries are const so several threads can
+// search at once with their own contexts, but not during build or repair
+class HierarchicalGrid {
+public:
+
+	HierarchicalGrid() : m_grid(nullptr), m_clusterSize(0), m_clustersWide(0), m_clustersHigh(0) {}
+	~HierarchicalGrid() {}
+
+	// builds every cluster, the grid must outlive the hierarchy
+	void build(const Grid& grid, SearchContext& context, int clusterSize = 16);
+
+	// call after changing the walkability of cells within the area.
+	// Only the clusters containing the area are rebuilt, plus their
+	// neighbours if the area touches a border
+	void repair(SearchContext& context, int minX, int minY, int maxX, int maxY);
+	void repair(SearchContext& context, int x, int y) { repair(context, x, y, x, y); }
+
+	// searches the entrances, filling waypoints with the start cell,
+	// the entrance cells to pass through and the end cell
+	bool findAbstractPath(SearchContext& context, int startX, int startY, int endX, int endY, std::vector<unsigned int>& waypoints) const;
+
+	// appends the cells after from up to and including to,
+	// where from and to are consecutive waypoints
+	bool refineSegment(SearchContext& context, unsigned int from, unsigned int to, std::vector<unsigned int>& cells) const;
+
+	// finds the abstract path and refines all of it
+	bool findPath(SearchContext& context, int startX, int startY, int endX, int endY, std::vector<unsigned int>& path) const;
+
+	// as above but returns the nodes for each cell, where cellNodes holds
+	// a node for every cell of the grid (nullptr for unwalkable cells)
+	bool findPath(SearchContext& context, int startX, int startY, int endX, int endY,
+				  const std::vector<Node*>& cellNodes, Path& path) const;
+
+	int getClusterSize() const { return m_clusterSize; }
+	unsigned int getClusterCount() const { return (unsigned int)m_clusters.size(); }
+	unsigned int getEntranceCount() const;
+
+protected:
+
+	enum {
+		// open stretches of border at least this long get an entrance
+		// at each end rather than one in the middle
+		LONG_ENTRANCE_LENGTH = 6,
+	};
+
+	// a link from an entrance to a cell, either another entrance in the
+	// same cluster or the cell across the border
+	struct Link {
+		unsigned int target;
+		float cost;
+	};
+
+	struct Entrance {
+		unsigned int cell;
+		std::vector<Link> links;
+	};
+
+	struct Cluster {
+		int minX, minY, maxX, maxY;
+		std::vector<Entrance> entrances;
+	};
+
+	// search adapters, defined in the .cpp
+	struct ClusterEdges;
+	struct AbstractEdges;
+
+	int getClusterIndex(unsigned int cell) const;
+
+	// the entrance at a cell or nullptr
+	const Entrance* getEntrance(unsigned int cell) const;
+
+	// finds a cluster's entrances and the costs between them
+	void buildCluster(SearchContext& context, int index);
+
+	// the pairs of cells (inside, outside) where entrances cross the
+	// border on one side of a cluster
+	void findTransitions(const Cluster& cluster, int dx, int dy, std::vector<std::pair<unsigned int, unsigned int>>& transitions) const;
+
+	// dijkstra from a cell to every cell of its cluster
+	void searchCluster(SearchContext& context, unsigned int cell) const;
+
+	// links from a cell to the entrances of its cluster, and to goal
+	// if it shares the cluster and can be reached within it
+	void connect(SearchContext& context, unsigned int cell, unsigned int goal, std::vector<Link>& links) const;
+
+	const Grid*	m_grid;
+
+	int		m_clusterSize;
+	int		m_clustersWide, m_clustersHigh;
+
+	std::vector<Cluster>		m_clusters;
+
+	// for each cell the index of its entrance within its cluster,
+	// or INVALID_INDEX if it isn't one
+	std::vector<unsigned int>	m_cellEntrances;
+};
+
+} // namespace graph
\ No newline at end of file
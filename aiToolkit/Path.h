@@ -0,0 +1,151 @@
+#pragma once
+
+#include <vector>
+#include <mutex>
+#include <algorithm>
+
+namespace graph {
+
+class Node;
+
+// a path stored contiguously. Waypoints are consumed by moving a cursor
+// rather than erasing them, so following a path is a linear scan, and
+// clearing keeps the memory so refilling a path doesn't allocate.
+// The storage comes from a shared pool and goes back to it when the path
+// is destroyed, so short-lived paths reuse each other's memory. The pool
+// is shared rather than per thread because paths are often found on a
+// worker thread and then handed to the main thread
+template <typename T>
+class BasicPath {
+public:
+
+	BasicPath() : m_points(acquire()), m_cursor(0) {}
+	BasicPath(const BasicPath& other) : m_points(acquire()), m_cursor(0) {
+		m_points->assign(other.begin(), other.end());
+	}
+	// takes the other path's storage without going to the pool, leaving
+	// it with none until it is next written to
+	BasicPath(BasicPath&& other) noexcept : m_points(other.m_points), m_cursor(other.m_cursor) {
+		other.m_points = nullptr;
+		other.m_cursor = 0;
+	}
+	~BasicPath() {
+		if (m_points != nullptr)
+			release(m_points);
+	}
+
+	BasicPath& operator = (const BasicPath& other) {
+		if (this != &other) {
+			getStorage().assign(other.begin(), other.end());
+			m_cursor = 0;
+		}
+		return *this;
+	}
+	BasicPath& operator = (BasicPath&& other) noexcept {
+		swap(other);
+		return *this;
+	}
+
+	// the waypoints that haven't been consumed yet
+	bool empty() const { return m_points == nullptr || m_cursor >= m_points->size(); }
+	size_t size() const { return m_points == nullptr ? 0 : m_points->size() - m_cursor; }
+
+	const T& front() const { return (*m_points)[m_cursor]; }
+	const T& back() const { return m_points->back(); }
+	const T& operator [] (size_t index) const { return (*m_points)[m_cursor + index]; }
+
+	const T* begin() const { return m_points == nullptr ? nullptr : m_points->data() + m_cursor; }
+	const T* end() const { return m_points == nullptr ? nullptr : m_points->data() + m_points->size(); }
+
+	// moves on to the next waypoint
+	void popFront() { ++m_cursor; }
+
+	void clear() {
+		if (m_points != nullptr)
+			m_points->clear();
+		m_cursor = 0;
+	}
+
+	void pushBack(const T& point) { getStorage().push_back(point); }
+
+	void reverse() {
+		if (m_points != nullptr)
+			std::reverse(m_points->begin() + m_cursor, m_points->end());
+	}
+
+	void swap(BasicPath& other) noexcept {
+		std::swap(m_points, other.m_points);
+		std::swap(m_cursor, other.m_cursor);
+	}
+
+	bool operator == (const BasicPath& rhs) const {
+		return size() == rhs.size() && std::equal(begin(), end(), rhs.begin());
+	}
+	bool operator != (const BasicPath& rhs) const { return !(*this == rhs); }
+
+protected:
+
+	typedef std::vector<T> Storage;
+
+	enum {
+		// storage beyond this is freed rather than pooled
+		MAX_POOLED = 256,
+	};
+
+	struct Pool {
+		std::mutex				mutex;
+		std::vector<Storage*>	free;
+
+		~Pool() {
+			for (auto storage : free)
+				delete storage;
+		}
+	};
+
+	static Pool& getPool() {
+		static Pool pool;
+		return pool;
+	}
+
+	static Storage* acquire() {
+		auto& pool = getPool();
+		{
+			std::lock_guard<std::mutex> lock(pool.mutex);
+			if (pool.free.empty() == false) {
+				Storage* storage = pool.free.back();
+				pool.free.pop_back();
+				return storage;
+			}
+		}
+		return new Storage();
+	}
+
+	static void release(Storage* storage) {
+		storage->clear();
+		auto& pool = getPool();
+		{
+			std::lock_guard<std::mutex> lock(pool.mutex);
+			if (pool.free.size() < MAX_POOLED) {
+				pool.free.push_back(storage);
+				return;
+			}
+		}
+		delete storage;
+	}
+
+	// the storage, taken from the pool if the path was moved from
+	Storage& getStorage() {
+		if (m_points == nullptr)
+			m_points = acquire();
+		return *m_points;
+	}
+
+	// null once moved from
+	Storage*	m_points;
+	size_t		m_cursor;
+};
+
+// a path of graph nodes as found by the searches
+typedef BasicPath<Node*> Path;
+
+} // namespace graph
\ No newline at end of file
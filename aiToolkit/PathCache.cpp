@@ -0,0 +1,116 @@
+#include "PathCache.h"
+
+namespace graph {
+
+PathCache::PathCache(unsigned int capacity)
+	: m_capacity(capacity),
+	m_hits(0),
+	m_misses(0) {
+}
+
+bool PathCache::aStar(SearchContext& context, Node* start, Node* end, Path& path,
+					  Search::HeuristicCheck heuristic, unsigned int heuristicID) {
+
+	return findPath(context, start, end, heuristicID,
+					[start, end, &heuristic](SearchContext& context, Path& path) {
+						return Search::aStar(context, start, end, path, heuristic);
+					},
+					path);
+}
+
+bool PathCache::findPath(SearchContext& context, Node* start, Node* end, unsigned int heuristicID,
+						 Solver solver, Path& path) {
+
+	path.clear();
+
+	if (start == nullptr ||
+		end == nullptr)
+		return false;
+
+	Key key = { start->getID(), end->getID(), heuristicID };
+
+	const GraphVersion& graph = start->getGraphVersion();
+	unsigned int version = graph.get();
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		auto iter = m_entries.find(key);
+		if (iter != m_entries.end()) {
+
+			if (iter->second.graph == &graph &&
+				iter->second.version == version) {
+				++m_hits;
+				m_recent.splice(m_recent.begin(), m_recent, iter->second.recent);
+				path = iter->second.path;
+				return iter->second.found;
+			}
+
+			// found on an older version of the graph
+			m_recent.erase(iter->second.recent);
+			m_entries.erase(iter);
+		}
+
+		++m_misses;
+	}
+
+	// search outside of the lock so other threads can use the cache
+	bool found = solver(context, path);
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	// don't keep a result if the graph changed during the search
+	if (graph.get() != version ||
+		m_capacity == 0)
+		return found;
+
+	// another thread may have found it meanwhile
+	auto iter = m_entries.find(key);
+	if (iter != m_entries.end())
+		return found;
+
+	m_recent.push_front(key);
+
+	Entry& entry = m_entries[key];
+	entry.found = found;
+	entry.path = path;
+	entry.graph = &graph;
+	entry.version = version;
+	entry.recent = m_recent.begin();
+
+	while (m_entries.size() > m_capacity) {
+		m_entries.erase(m_recent.back());
+		m_recent.pop_back();
+	}
+
+	return found;
+}
+
+void PathCache::clear() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_entries.clear();
+	m_recent.clear();
+}
+
+unsigned int PathCache::getSize() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return (unsigned int)m_entries.size();
+}
+
+unsigned int PathCache::getHitCount() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_hits;
+}
+
+unsigned int PathCache::getMissCount() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_misses;
+}
+
+void PathCache::resetCounts() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_hits = 0;
+	m_misses = 0;
+}
+
+} // namespace graph
\ No newline at end of file
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "Pathfinding.h"
+
+#include <map>
+#include <mutex>
+
+namespace graph {
+
+// remembers recent search results so that repeated requests between the
+// same two nodes don't search again. Entries are keyed on the start, the
+// goal and a heuristic ID chosen by the caller, since different
+// heuristics or search types can give different paths. The least
+// recently used entry is evicted once full, and an entry is dropped once
+// the version of its start node's graph has changed since it was found
+// (see Node::getGraphVersion), so changing one graph keeps the paths on
+// any other. It is thread-safe so it can be shared by path request workers
+class PathCache {
+public:
+
+	// runs the search for a miss
+	typedef std::function<bool(SearchContext& context, Path& path)> Solver;
+
+	PathCache(unsigned int capacity = 256);
+	~PathCache() {}
+
+	// the cached result for an A* search, searching on a miss
+	bool aStar(SearchContext& context, Node* start, Node* end, Path& path,
+			   Search::HeuristicCheck heuristic, unsigned int heuristicID = 0);
+
+	// the cached result for any other search between two nodes
+	bool findPath(SearchContext& context, Node* start, Node* end, unsigned int heuristicID,
+				  Solver solver, Path& path);
+
+	void clear();
+
+	unsigned int getCapacity() const { return m_capacity; }
+	unsigned int getSize() const;
+
+	unsigned int getHitCount() const;
+	unsigned int getMissCount() const;
+	void resetCounts();
+
+protected:
+
+	struct Key {
+		unsigned int start, end, heuristicID;
+
+		bool operator < (const Key& rhs) const {
+			if (start != rhs.start) return start < rhs.start;
+			if (end != rhs.end) return end < rhs.end;
+			return heuristicID < rhs.heuristicID;
+		}
+	};
+
+	struct Entry {
+		// failed searches are cached too
+		bool found;
+		Path path;
+
+		// the start node's graph and its version when found, as a
+		// deleted node's ID can be reused in another graph
+		const GraphVersion*	graph;
+		unsigned int		version;
+
+		// position in the recently used list
+		std::list<Key>::iterator recent;
+	};
+
+	mutable std::mutex	m_mutex;
+
+	unsigned int	m_capacity;
+
+	unsigned int	m_hits, m_misses;
+
+	std::map<Key, Entry>	m_entries;
+
+	// most recently used first
+	std::list<Key>			m_recent;
+};
+
+} // namespace graph
\ No newline at end of file
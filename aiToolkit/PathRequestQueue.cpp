@@ -0,0 +1,203 @@
+#include "PathRequestQueue.h"
+#include "Agent.h"
+
+namespace ai {
+
+PathRequestQueue::PathRequestQueue(unsigned int threadCount)
+	: m_quit(false),
+	m_activeCount(0),
+	m_nextID(1) {
+
+	if (threadCount == 0) {
+		threadCount = std::thread::hardware_concurrency();
+		threadCount = threadCount > 1 ? threadCount - 1 : 1;
+	}
+
+	for (unsigned int i = 0; i < threadCount; ++i)
+		m_threads.push_back(std::thread(&PathRequestQueue::workerThread, this));
+}
+
+PathRequestQueue::~PathRequestQueue() {
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_quit = true;
+	}
+	m_condition.notify_all();
+
+	for (auto& thread : m_threads)
+		thread.join();
+}
+
+PathRequestQueue::RequestID PathRequestQueue::submit(Agent* agent,
+													 graph::Node* start, graph::Node* end,
+													 graph::Search::HeuristicCheck heuristic,
+													 int priority, Callback callback) {
+
+	return submit(agent,
+				  [start, end, heuristic](graph::SearchContext& context, graph::Path& path) {
+					  return graph::Search::aStar(context, start, end, path, heuristic);
+				  },
+				  priority, callback);
+}
+
+PathRequestQueue::RequestID PathRequestQueue::submit(Agent* agent, Solver solver,
+													 int priority, Callback callback) {
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	// replace any request already in flight for the agent
+	auto iter = m_pending.find(agent);
+	if (iter != m_pending.end())
+		cancelLocked(iter->second, agent);
+
+	RequestID id = m_nextID++;
+
+	// skip the invalid ID on wrap-around
+	if (m_nextID == 0)
+		m_nextID = 1;
+
+	Request request = { id, agent, solver, callback };
+	m_queued.insert(std::make_pair(priority, request));
+	m_pending[agent] = id;
+
+	lock.unlock();
+	m_condition.notify_one();
+
+	return id;
+}
+
+bool PathRequestQueue::cancel(RequestID id) {
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	for (auto& pending : m_pending) {
+		if (pending.second == id)
+			return cancelLocked(id, pending.first);
+	}
+
+	return false;
+}
+
+bool PathRequestQueue::cancel(Agent* agent) {
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	auto iter = m_pending.find(agent);
+	if (iter == m_pending.end())
+		return false;
+
+	return cancelLocked(iter->second, agent);
+}
+
+bool PathRequestQueue::cancelLocked(RequestID id, Agent* agent) {
+
+	m_pending.erase(agent);
+
+	// remove it if it hasn't been started yet
+	for (auto iter = m_queued.begin(); iter != m_queued.end(); ++iter) {
+		if (iter->second.id == id) {
+			m_queued.erase(iter);
+			return true;
+		}
+	}
+
+	// or if it has finished but not been delivered
+	for (auto iter = m_completed.begin(); iter != m_completed.end(); ++iter) {
+		if (iter->id == id) {
+			m_completed.erase(iter);
+			return true;
+		}
+	}
+
+	// otherwise a worker is solving it and will discard the result
+	return true;
+}
+
+void PathRequestQueue::clear() {
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	m_queued.clear();
+	m_pending.clear();
+	m_completed.clear();
+
+	m_idleCondition.wait(lock, [this]() { return m_activeCount == 0; });
+}
+
+bool PathRequestQueue::isPending(Agent* agent) const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_pending.find(agent) != m_pending.end();
+}
+
+size_t PathRequestQueue::getPendingCount() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_pending.size();
+}
+
+unsigned int PathRequestQueue::update(unsigned int maxResults) {
+
+	std::vector<Result> results;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		while (results.size() < maxResults &&
+			   m_completed.empty() == false) {
+			m_pending.erase(m_completed.front().agent);
+			results.push_back(std::move(m_completed.front()));
+			m_completed.pop_front();
+		}
+	}
+
+	// write the paths into the agents outside of the lock
+	for (auto& result : results) {
+
+		graph::Path* path = nullptr;
+		if (result.agent->getBlackboard().get("path", &path))
+			path->swap(result.path);
+
+		if (result.callback)
+			result.callback(result.agent, result.found);
+	}
+
+	return (unsigned int)results.size();
+}
+
+void PathRequestQueue::workerThread() {
+
+	// each worker has its own search data so they can share the graph
+	graph::SearchContext context;
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	while (true) {
+
+		m_condition.wait(lock, [this]() { return m_quit || m_queued.empty() == false; });
+
+		if (m_quit)
+			return;
+
+		Request request = m_queued.begin()->second;
+		m_queued.erase(m_queued.begin());
+		++m_activeCount;
+
+		lock.unlock();
+
+		Result result = { request.id, request.agent, false, {}, request.callback };
+		result.found = request.solver(context, result.path);
+
+		lock.lock();
+
+		// only keep the result if it wasn't cancelled or replaced meanwhile
+		auto iter = m_pending.find(request.agent);
+		if (iter != m_pending.end() &&
+			iter->second == request.id)
+			m_completed.push_back(std::move(result));
+
+		if (--m_activeCount == 0)
+			m_idleCondition.notify_all();
+	}
+}
+
+} // namespace ai
\ No newline at end of file
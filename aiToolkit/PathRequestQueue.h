@@ -0,0 +1,111 @@
+#pragma once
+
+#include "Pathfinding.h"
+
+#include <map>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <climits>
+
+namespace ai {
+
+class Agent;
+
+// solves path requests on a pool of worker threads so that searches
+// don't stall the frame. Completed paths are written into the agent's
+// blackboard "path" entry (a graph::Path*) during update(),
+// which should be called once per frame from the main thread.
+// Each agent can have one request in flight; submitting another
+// replaces it. The graph must not be modified while requests are
+// pending, and agents must cancel their requests before being deleted.
+class PathRequestQueue {
+public:
+
+	typedef unsigned int RequestID;
+
+	// called on the main thread after the path has been written
+	typedef std::function<void(Agent* agent, bool found)> Callback;
+
+	// runs a search on a worker thread using that worker's context,
+	// returning true if a path was found
+	typedef std::function<bool(graph::SearchContext& context, graph::Path& path)> Solver;
+
+	// 0 threads will use one less than the hardware thread count
+	PathRequestQueue(unsigned int threadCount = 0);
+	~PathRequestQueue();
+
+	// queues an A* search for the agent, higher priority requests are
+	// solved first. Returns an ID that can be used to cancel it
+	RequestID submit(Agent* agent, graph::Node* start, graph::Node* end,
+					 graph::Search::HeuristicCheck heuristic,
+					 int priority = 0, Callback callback = nullptr);
+
+	// queues any other kind of search, such as a grid search
+	RequestID submit(Agent* agent, Solver solver,
+					 int priority = 0, Callback callback = nullptr);
+
+	// cancels a request, or whatever request an agent has in flight.
+	// returns false if it was not pending
+	bool cancel(RequestID id);
+	bool cancel(Agent* agent);
+
+	// cancels everything and waits for searches in progress to finish,
+	// which must be done before the graph is modified or deleted
+	void clear();
+
+	// true from submit until the result has been delivered
+	bool isPending(Agent* agent) const;
+
+	// delivers up to maxResults completed paths,
+	// returning how many were delivered
+	unsigned int update(unsigned int maxResults = UINT_MAX);
+
+	size_t getPendingCount() const;
+	unsigned int getThreadCount() const { return (unsigned int)m_threads.size(); }
+
+protected:
+
+	struct Request {
+		RequestID	id;
+		Agent*		agent;
+		Solver		solver;
+		Callback	callback;
+	};
+
+	struct Result {
+		RequestID	id;
+		Agent*		agent;
+		bool		found;
+		graph::Path	path;
+		Callback	callback;
+	};
+
+	void workerThread();
+
+	// must be called while holding m_mutex
+	bool cancelLocked(RequestID id, Agent* agent);
+
+	mutable std::mutex		m_mutex;
+	std::condition_variable	m_condition;
+	std::condition_variable	m_idleCondition;
+	bool					m_quit;
+
+	// searches currently being run by workers
+	unsigned int			m_activeCount;
+
+	RequestID				m_nextID;
+
+	// queued by priority, with equal priorities kept in submit order
+	std::multimap<int, Request, std::greater<int>>	m_queued;
+
+	// every agent with a request that has not been delivered yet
+	std::map<Agent*, RequestID>	m_pending;
+
+	std::deque<Result>			m_completed;
+
+	std::vector<std::thread>	m_threads;
+};
+
+} // namespace ai
\ No newline at end of file
@@ -1,222 +1,915 @@
 #include "Pathfinding.h"
+#include "CsrGraph.h"
+#include "Grid.h"
+#include "SearchLoop.h"
 
-#include <set>
+#include <mutex>
+#include <algorithm>
+#include <limits>
 
 namespace graph {
 
-bool Search::dijkstra(Node* start, Node* end, std::list<Node*>& path) {
+// hands out dense node IDs, reusing the IDs of deleted nodes
+struct NodeIDPool {
+	std::mutex					mutex;
+	std::vector<unsigned int>	freeIDs;
+	unsigned int				count = 0;
+};
 
-	std::list<Node*> openList;
-	std::set<Node*> closedList;
+static NodeIDPool& getIDPool() {
+	static NodeIDPool pool;
+	return pool;
+}
 
-	path.clear();
+GraphVersion& GraphVersion::getDefault() {
+	static GraphVersion version;
+	return version;
+}
 
-	start->previous = nullptr;
-	start->gScore = 0;
+// an edge belongs to the graph of the node it leaves
+static void markEdgeChanged(const Edge& edge) {
+	Node* node = edge.source != nullptr ? edge.source : edge.target;
+	if (node != nullptr)
+		node->markGraphChanged();
+}
 
-	end->previous = nullptr;
+void Edge::setCost(float c) {
+	cost = c;
+	markEdgeChanged(*this);
+}
 
-	openList.push_front(start);
+void Edge::setFlags(unsigned int f) {
+	flags = f;
+	markEdgeChanged(*this);
+}
 
-	// do search
-	while (openList.empty() == false) {
+Node::Node() : flags(0), previous(nullptr), m_version(&GraphVersion::getDefault()) {
+	auto& pool = getIDPool();
+	std::lock_guard<std::mutex> lock(pool.mutex);
+	if (pool.freeIDs.empty()) {
+		m_id = pool.count++;
+	}
+	else {
+		m_id = pool.freeIDs.back();
+		pool.freeIDs.pop_back();
+	}
+}
 
-		openList.sort(Node::compareGScore);
+Node::~Node() {
+	for (auto e : edges)
+		delete e;
 
-		Node* current = openList.front();
+	auto& pool = getIDPool();
+	std::lock_guard<std::mutex> lock(pool.mutex);
+	pool.freeIDs.push_back(m_id);
 
-		if (current == end)
-			break;
+	// the ID will be reused by another node
+	markGraphChanged();
+}
 
-		openList.pop_front();
-		closedList.insert(current);
-
-		// add all connections to openList
-		for (auto edge : current->edges) {
-
-			Node* target = edge->target;
-			float gScore = current->gScore + edge->cost;
-
-			// is it already closed?
-			if (closedList.find(target) == closedList.end()) {
-
-				auto iter = std::find(openList.begin(), openList.end(), target);
-				if (iter == openList.end()) {
-					// add to open list
-					target->previous = current;
-					target->gScore = gScore;
-					openList.push_back(target);
-				}
-				else if (gScore < target->gScore) {
-					target->gScore = gScore;
-					target->previous = current;
-				}
-			}
-		}
+unsigned int Node::getIDCount() {
+	auto& pool = getIDPool();
+	std::lock_guard<std::mutex> lock(pool.mutex);
+	return pool.count;
+}
+
+Edge* Node::addEdge(Node* target, float cost, unsigned int flags) {
+	Edge* edge = new Edge(target, cost);
+	edge->source = this;
+	edge->flags = flags;
+	edges.push_back(edge);
+	markGraphChanged();
+	return edge;
+}
+
+bool Node::removeEdge(Edge* edge) {
+	auto iter = std::find(edges.begin(), edges.end(), edge);
+	if (iter == edges.end())
+		return false;
+	edges.erase(iter);
+	delete edge;
+	markGraphChanged();
+	return true;
+}
+
+void Node::setGraphVersion(GraphVersion* version) {
+	if (version == nullptr)
+		version = &GraphVersion::getDefault();
+	if (version == m_version)
+		return;
+	m_version->markChanged();
+	m_version = version;
+	m_version->markChanged();
+}
+
+bool SearchContext::getScores(Node* node, float& gScore, float& fScore, Node*& previous) const {
+
+	unsigned int index = 0;
+	if (node == nullptr ||
+		getScores(node->getID(), gScore, fScore, index) == false ||
+		m_records[node->getID()].node != node)
+		return false;
+
+	previous = index == INVALID_INDEX ? nullptr : m_records[index].node;
+	return true;
+}
+
+bool SearchContext::getScores(unsigned int index, float& gScore, float& fScore, unsigned int& previous) const {
+
+	if (index >= m_records.size())
+		return false;
+
+	auto& record = m_records[index];
+	if (record.searchID != m_searchID)
+		return false;
+
+	gScore = record.gScore;
+	fScore = record.fScore;
+	previous = record.previous;
+	return true;
+}
+
+void SearchContext::begin(unsigned int count) {
+
+	// grow to fit any nodes created since the last search
+	if (m_records.size() < count)
+		m_records.resize(count, Record{ 0, 0, 0, INVALID_INDEX, nullptr, 0, -1, false });
+
+	// on wrap-around stale records could match again so clear them
+	if (++m_searchID == 0) {
+		for (auto& record : m_records)
+			record.searchID = 0;
+		m_searchID = 1;
 	}
 
-	// did we find a path?
-	if (end->previous != nullptr) {
-		// path found!
-		while (end != nullptr) {
-			path.push_front(end);
-			end = end->previous;
-		}
+	m_open.clear();
+	m_expandedCount = 0;
+}
 
-		return true;
+SearchContext::Record& SearchContext::visit(unsigned int index, Node* node, bool& reached) {
+
+	// a node created after the search began
+	if (index >= m_records.size())
+		m_records.resize(index + 1, Record{ 0, 0, 0, INVALID_INDEX, nullptr, 0, -1, false });
+
+	auto& record = m_records[index];
+
+	reached = record.searchID == m_searchID;
+	if (reached == false) {
+		record.searchID = m_searchID;
+		record.previous = INVALID_INDEX;
+		record.node = node;
+		record.heapIndex = -1;
+		record.closed = false;
 	}
-	
-	return false;
+
+	return record;
 }
 
-bool Search::dijkstraFindFlags(Node* start, unsigned int flags, std::list<Node*>& path) {
+void SearchContext::push(unsigned int index) {
+	m_records[index].heapIndex = (int)m_open.size();
+	m_open.push_back(index);
+	siftUp((int)m_open.size() - 1);
+}
 
-	std::list<Node*> openList;
-	std::set<Node*> closedList;
+unsigned int SearchContext::pop() {
+	++m_expandedCount;
 
-	path.clear();
+	unsigned int top = m_open.front();
+	m_records[top].heapIndex = -1;
 
-	start->previous = nullptr;
-	start->gScore = 0;
+	unsigned int last = m_open.back();
+	m_open.pop_back();
 
-	Node* end = nullptr;
-	
-	openList.push_front(start);
+	if (m_open.empty() == false) {
+		m_open[0] = last;
+		m_records[last].heapIndex = 0;
+		siftDown(0);
+	}
 
-	// do search
-	while (openList.empty() == false) {
+	return top;
+}
 
-		openList.sort(Node::compareGScore);
+void SearchContext::decrease(unsigned int index) {
+	siftUp(m_records[index].heapIndex);
+}
 
-		Node* current = openList.front();
+void SearchContext::siftUp(int position) {
+	unsigned int index = m_open[position];
+	float score = m_records[index].fScore;
+	while (position > 0) {
+		int parent = (position - 1) / 2;
+		if (score >= m_records[m_open[parent]].fScore)
+			break;
+		m_open[position] = m_open[parent];
+		m_records[m_open[position]].heapIndex = position;
+		position = parent;
+	}
+	m_open[position] = index;
+	m_records[index].heapIndex = position;
+}
 
-		// must contain all of the requested flags
-		if ((current->flags & flags) == flags) {
-			end = current;
+void SearchContext::siftDown(int position) {
+	unsigned int index = m_open[position];
+	float score = m_records[index].fScore;
+	int count = (int)m_open.size();
+	while (true) {
+		int child = position * 2 + 1;
+		if (child >= count)
+			break;
+		if (child + 1 < count &&
+			m_records[m_open[child + 1]].fScore < m_records[m_open[child]].fScore)
+			++child;
+		if (m_records[m_open[child]].fScore >= score)
 			break;
+		m_open[position] = m_open[child];
+		m_records[m_open[position]].heapIndex = position;
+		position = child;
+	}
+	m_open[position] = index;
+	m_records[index].heapIndex = position;
+}
+
+// lets the search loop walk the packed edges of a CsrGraph
+struct CsrGraphEdges {
+
+	const CsrGraph& graph;
+
+	template <typename Visit>
+	void forEach(Node*, unsigned int index, Visit visit) const {
+		for (auto edge = graph.edgesBegin(index); edge != graph.edgesEnd(index); ++edge)
+			visit(edge->target, nullptr, edge->cost);
+	}
+};
+
+// lets the search loop walk the edges of a CsrGraph backwards
+struct CsrGraphIncomingEdges {
+
+	const CsrGraph& graph;
+
+	template <typename Visit>
+	void forEach(Node*, unsigned int index, Visit visit) const {
+		for (auto edge = graph.incomingBegin(index); edge != graph.incomingEnd(index); ++edge)
+			visit(edge->target, nullptr, edge->cost);
+	}
+};
+
+// lets the search loop walk a grid by jump points. Neighbours that
+// could be reached at least as cheaply without passing through the cell
+// are pruned, and each remaining direction is followed until it reaches
+// the goal or a cell with a forced neighbour, so that only those cells
+// ever enter the open list
+struct JumpPointEdges {
+
+	const Grid& grid;
+	const SearchContext& context;
+	int goalX, goalY;
+
+	template <typename Visit>
+	void forEach(Node*, unsigned int index, Visit visit) const {
+
+		int x = index % grid.getWidth();
+		int y = index / grid.getWidth();
+
+		int directions[8][2];
+		int count = getDirections(x, y, index, directions);
+
+		for (int i = 0; i < count; ++i) {
+			int jx = 0, jy = 0;
+			if (jump(x, y, directions[i][0], directions[i][1], jx, jy))
+				visit(grid.getIndex(jx, jy), nullptr, Grid::octileDistance(x, y, jx, jy));
 		}
+	}
 
-		openList.pop_front();
-		closedList.insert(current);
-
-		// add all connections to openList
-		for (auto edge : current->edges) {
-
-			Node* target = edge->target;
-			float gScore = current->gScore + edge->cost;
-
-			// is it already closed?
-			if (closedList.find(target) == closedList.end()) {
-
-				auto iter = std::find(openList.begin(), openList.end(), target);
-				if (iter == openList.end()) {
-					// add to open list
-					target->previous = current;
-					target->gScore = gScore;
-					openList.push_back(target);
-				}
-				else if (gScore < target->gScore) {
-					target->gScore = gScore;
-					target->previous = current;
-				}
+	// the directions worth searching from a cell given the direction we
+	// arrived from, returning how many were written
+	int getDirections(int x, int y, unsigned int index, int directions[8][2]) const {
+
+		int count = 0;
+		auto add = [&](int dx, int dy) {
+			directions[count][0] = dx;
+			directions[count][1] = dy;
+			++count;
+		};
+
+		float gScore, fScore;
+		unsigned int previous = INVALID_INDEX;
+		context.getScores(index, gScore, fScore, previous);
+
+		// the start cell searches every direction
+		if (previous == INVALID_INDEX) {
+			for (int dy = -1; dy <= 1; ++dy)
+				for (int dx = -1; dx <= 1; ++dx)
+					if (dx != 0 || dy != 0)
+						add(dx, dy);
+			return count;
+		}
+
+		int px = previous % grid.getWidth();
+		int py = previous / grid.getWidth();
+		int dx = x > px ? 1 : (x < px ? -1 : 0);
+		int dy = y > py ? 1 : (y < py ? -1 : 0);
+
+		if (dx != 0 && dy != 0) {
+			// diagonal moves continue straight along either axis or diagonally
+			bool horizontal = grid.isWalkable(x + dx, y);
+			bool vertical = grid.isWalkable(x, y + dy);
+			if (vertical)
+				add(0, dy);
+			if (horizontal)
+				add(dx, 0);
+			if (horizontal && vertical)
+				add(dx, dy);
+		}
+		else if (dx != 0) {
+			// sideways cells are only forced if the cell beside the
+			// previous one is blocked, otherwise it would have been cheaper
+			bool next = grid.isWalkable(x + dx, y);
+			bool up = grid.isWalkable(x, y + 1) && grid.isWalkable(x - dx, y + 1) == false;
+			bool down = grid.isWalkable(x, y - 1) && grid.isWalkable(x - dx, y - 1) == false;
+			if (next)
+				add(dx, 0);
+			if (up) {
+				add(0, 1);
+				if (next)
+					add(dx, 1);
+			}
+			if (down) {
+				add(0, -1);
+				if (next)
+					add(dx, -1);
 			}
 		}
+		else {
+			bool next = grid.isWalkable(x, y + dy);
+			bool right = grid.isWalkable(x + 1, y) && grid.isWalkable(x + 1, y - dy) == false;
+			bool left = grid.isWalkable(x - 1, y) && grid.isWalkable(x - 1, y - dy) == false;
+			if (next)
+				add(0, dy);
+			if (right) {
+				add(1, 0);
+				if (next)
+					add(1, dy);
+			}
+			if (left) {
+				add(-1, 0);
+				if (next)
+					add(-1, dy);
+			}
+		}
+
+		return count;
 	}
 
-	// did we find a path?
-	if (end->previous != nullptr) {
-		// path found!
-		while (end != nullptr) {
-			path.push_front(end);
-			end = end->previous;
+	// steps from a cell in a direction until reaching a jump point,
+	// returning false if it runs into a wall first
+	bool jump(int x, int y, int dx, int dy, int& jx, int& jy) const {
+
+		if (dx == 0 || dy == 0)
+			return jumpStraight(x, y, dx, dy, jx, jy);
+
+		while (true) {
+
+			// diagonals can't cut corners
+			if (grid.isWalkable(x + dx, y) == false ||
+				grid.isWalkable(x, y + dy) == false)
+				return false;
+
+			x += dx;
+			y += dy;
+
+			if (grid.isWalkable(x, y) == false)
+				return false;
+
+			// a cell is a jump point if either straight direction finds one
+			int sx, sy;
+			if ((x == goalX && y == goalY) ||
+				jumpStraight(x, y, dx, 0, sx, sy) ||
+				jumpStraight(x, y, 0, dy, sx, sy))
+				break;
 		}
 
+		jx = x;
+		jy = y;
 		return true;
 	}
 
-	return false;
+	bool jumpStraight(int x, int y, int dx, int dy, int& jx, int& jy) const {
+
+		while (true) {
+
+			x += dx;
+			y += dy;
+
+			if (grid.isWalkable(x, y) == false)
+				return false;
+
+			if (x == goalX && y == goalY)
+				break;
+
+			// stop at cells with a forced neighbour
+			if (dx != 0) {
+				if ((grid.isWalkable(x, y - 1) && grid.isWalkable(x - dx, y - 1) == false) ||
+					(grid.isWalkable(x, y + 1) && grid.isWalkable(x - dx, y + 1) == false))
+					break;
+			}
+			else {
+				if ((grid.isWalkable(x - 1, y) && grid.isWalkable(x - 1, y - dy) == false) ||
+					(grid.isWalkable(x + 1, y) && grid.isWalkable(x + 1, y - dy) == false))
+					break;
+			}
+		}
+
+		jx = x;
+		jy = y;
+		return true;
+	}
+};
+
+bool Search::buildPath(const SearchContext& context, Node* end, std::list<Node*>& path) {
+
+	float gScore, fScore;
+	Node* previous = nullptr;
+
+	// did we find a path?
+	if (end == nullptr ||
+		context.getScores(end, gScore, fScore, previous) == false ||
+		previous == nullptr)
+		return false;
+
+	// path found!
+	while (end != nullptr) {
+		path.push_front(end);
+		context.getScores(end, gScore, fScore, end);
+	}
+
+	return true;
+}
+
+bool Search::buildPath(const SearchContext& context, Node* end, Path& path) {
+
+	float gScore, fScore;
+	Node* previous = nullptr;
+
+	// did we find a path?
+	if (end == nullptr ||
+		context.getScores(end, gScore, fScore, previous) == false ||
+		previous == nullptr)
+		return false;
+
+	// path found! walk back from the end then flip it around
+	while (end != nullptr) {
+		path.pushBack(end);
+		context.getScores(end, gScore, fScore, end);
+	}
+
+	path.reverse();
+
+	return true;
+}
+
+bool Search::buildPath(const SearchContext& context, unsigned int end, std::vector<unsigned int>& path) {
+
+	float gScore, fScore;
+	unsigned int previous = INVALID_INDEX;
+
+	// did we find a path?
+	if (end == INVALID_INDEX ||
+		context.getScores(end, gScore, fScore, previous) == false ||
+		previous == INVALID_INDEX)
+		return false;
+
+	// path found!
+	while (end != INVALID_INDEX) {
+		path.push_back(end);
+		context.getScores(end, gScore, fScore, end);
+	}
+
+	std::reverse(path.begin(), path.end());
+
+	return true;
+}
+
+SearchContext& Search::getThreadContext() {
+	thread_local SearchContext context;
+	return context;
+}
+
+void Search::writeBack(SearchContext& context, const std::list<Node*>& path) {
+
+	for (auto node : path) {
+		auto& record = context.m_records[node->getID()];
+		node->gScore = record.gScore;
+		node->hScore = record.hScore;
+		node->fScore = record.fScore;
+		node->previous = record.previous == INVALID_INDEX ? nullptr : context.m_records[record.previous].node;
+	}
+}
+
+bool Search::dijkstra(Node* start, Node* end, std::list<Node*>& path) {
+
+	auto& context = getThreadContext();
+
+	if (end != nullptr)
+		end->previous = nullptr;
+
+	bool found = dijkstra(context, start, end, path);
+	writeBack(context, path);
+	return found;
+}
+
+bool Search::dijkstra(SearchContext& context, Node* start, Node* end, std::list<Node*>& path) {
+
+	path.clear();
+
+	if (start == nullptr ||
+		end == nullptr)
+		return false;
+
+	context.begin(Node::getIDCount());
+
+	unsigned int found = search(context, NodeGraphEdges<>(), start->getID(), start,
+								[end](unsigned int, Node* n) { return n == end; },
+								[](unsigned int, Node*) { return 0.0f; });
+
+	return buildPath(context, found == INVALID_INDEX ? nullptr : end, path);
+}
+
+bool Search::dijkstraFindFlags(Node* start, unsigned int flags, std::list<Node*>& path) {
+
+	auto& context = getThreadContext();
+
+	bool found = dijkstraFindFlags(context, start, flags, path);
+	writeBack(context, path);
+	return found;
+}
+
+bool Search::dijkstraFindFlags(SearchContext& context, Node* start, unsigned int flags, std::list<Node*>& path) {
+
+	path.clear();
+
+	if (start == nullptr)
+		return false;
+
+	context.begin(Node::getIDCount());
+
+	// must contain all of the requested flags
+	unsigned int found = search(context, NodeGraphEdges<>(), start->getID(), start,
+								[flags](unsigned int, Node* n) { return (n->flags & flags) == flags; },
+								[](unsigned int, Node*) { return 0.0f; });
+
+	return buildPath(context, found == INVALID_INDEX ? nullptr : context.m_records[found].node, path);
+}
+
+bool Search::dijkstra(SearchContext& context, const std::vector<Node*>& starts, const std::vector<Node*>& ends, std::list<Node*>& path) {
+
+	path.clear();
+
+	if (starts.empty() ||
+		ends.empty())
+		return false;
+
+	std::vector<unsigned int> startIDs, endIDs;
+	for (auto node : starts)
+		startIDs.push_back(node->getID());
+	for (auto node : ends)
+		endIDs.push_back(node->getID());
+
+	std::sort(endIDs.begin(), endIDs.end());
+
+	context.begin(Node::getIDCount());
+
+	unsigned int found = search(context, NodeGraphEdges<>(), (unsigned int)starts.size(), startIDs.data(), starts.data(),
+								[&endIDs](unsigned int n, Node*) { return std::binary_search(endIDs.begin(), endIDs.end(), n); },
+								[](unsigned int, Node*) { return 0.0f; });
+
+	return buildPath(context, found == INVALID_INDEX ? nullptr : context.m_records[found].node, path);
+}
+
+void Search::dijkstraFlood(SearchContext& context, const std::vector<Node*>& sources) {
+
+	std::vector<unsigned int> sourceIDs;
+	for (auto node : sources)
+		sourceIDs.push_back(node->getID());
+
+	context.begin(Node::getIDCount());
+
+	// never finds a goal so it reaches everything it can
+	search(context, NodeGraphEdges<>(), (unsigned int)sources.size(), sourceIDs.data(), sources.data(),
+		   [](unsigned int, Node*) { return false; },
+		   [](unsigned int, Node*) { return 0.0f; });
 }
 
 bool Search::aStar(Node* start, Node* end, std::list<Node*>& path, HeuristicCheck heuristic) {
 
+	auto& context = getThreadContext();
+
+	if (end != nullptr)
+		end->previous = nullptr;
+
+	bool found = aStar(context, start, end, path, heuristic);
+	writeBack(context, path);
+	return found;
+}
+
+bool Search::aStar(SearchContext& context, Node* start, Node* end, std::list<Node*>& path, HeuristicCheck heuristic) {
+	return aStar<HeuristicCheck, AnyEdge>(context, start, end, path, heuristic);
+}
+
+bool Search::dijkstra(SearchContext& context, Node* start, Node* end, Path& path) {
+
+	path.clear();
+
 	if (start == nullptr ||
 		end == nullptr)
 		return false;
 
-	std::list<Node*> openList;
-	std::set<Node*> closedList;
+	context.begin(Node::getIDCount());
+
+	unsigned int found = search(context, NodeGraphEdges<>(), start->getID(), start,
+								[end](unsigned int, Node* n) { return n == end; },
+								[](unsigned int, Node*) { return 0.0f; });
+
+	return buildPath(context, found == INVALID_INDEX ? nullptr : end, path);
+}
+
+bool Search::aStar(SearchContext& context, Node* start, Node* end, Path& path, HeuristicCheck heuristic) {
+	return aStar<HeuristicCheck, AnyEdge>(context, start, end, path, heuristic);
+}
+
+bool Search::dijkstra(const CsrGraph& graph, SearchContext& context,
+					  unsigned int start, unsigned int end, std::vector<unsigned int>& path) {
 
 	path.clear();
 
-	start->previous = nullptr;
-	start->gScore = 0;
-	start->hScore = heuristic(start, end);
-	start->fScore = start->gScore + start->fScore;
+	if (start >= graph.getNodeCount() ||
+		end >= graph.getNodeCount())
+		return false;
 
-	end->previous = nullptr;
+	context.begin(graph.getNodeCount());
 
-	openList.push_front(start);
+	unsigned int found = search(context, CsrGraphEdges{ graph }, start, nullptr,
+								[end](unsigned int n, Node*) { return n == end; },
+								[](unsigned int, Node*) { return 0.0f; });
 
-	// do search
-	while (openList.empty() == false) {
+	return buildPath(context, found, path);
+}
 
-		// compare with F rather than G
-		openList.sort(Node::compareFScore);
+bool Search::dijkstraFindFlags(const CsrGraph& graph, SearchContext& context,
+							   unsigned int start, unsigned int flags, std::vector<unsigned int>& path) {
 
-		Node* current = openList.front();
+	path.clear();
 
-		if (current == end)
-			break;
+	if (start >= graph.getNodeCount())
+		return false;
 
-		openList.pop_front();
-		closedList.insert(current);
+	context.begin(graph.getNodeCount());
 
-		// add all connections to openList
-		for (auto edge : current->edges) {
+	// must contain all of the requested flags
+	unsigned int found = search(context, CsrGraphEdges{ graph }, start, nullptr,
+								[&graph, flags](unsigned int n, Node*) { return (graph.getFlags(n) & flags) == flags; },
+								[](unsigned int, Node*) { return 0.0f; });
 
-			Node* target = edge->target;
-			float gScore = current->gScore + edge->cost;
+	return buildPath(context, found, path);
+}
 
-			// is it already closed?
-			if (closedList.find(target) == closedList.end()) {
+bool Search::aStar(const CsrGraph& graph, SearchContext& context,
+				   unsigned int start, unsigned int end, std::vector<unsigned int>& path,
+				   IndexHeuristicCheck heuristic) {
 
-				auto iter = std::find(openList.begin(), openList.end(), target);
-				if (iter == openList.end()) {
-					// add to open list
-					target->previous = current;
+	path.clear();
 
-					target->gScore = gScore;
+	if (start >= graph.getNodeCount() ||
+		end >= graph.getNodeCount())
+		return false;
+
+	context.begin(graph.getNodeCount());
+
+	unsigned int found = search(context, CsrGraphEdges{ graph }, start, nullptr,
+								[end](unsigned int n, Node*) { return n == end; },
+								[end, &heuristic](unsigned int n, Node*) { return heuristic(n, end); });
+
+	return buildPath(context, found, path);
+}
+
+void Search::dijkstraFlood(const CsrGraph& graph, SearchContext& context,
+						  const std::vector<unsigned int>& sources, bool incoming) {
+
+	context.begin(graph.getNodeCount());
+
+	std::vector<unsigned int> valid;
+	for (auto source : sources)
+		if (source < graph.getNodeCount())
+			valid.push_back(source);
+
+	// the loop only wants nodes for Node graphs
+	std::vector<Node*> nodes(valid.size(), nullptr);
+
+	// never finds a goal so it reaches everything it can
+	auto isGoal = [](unsigned int, Node*) { return false; };
+	auto heuristic = [](unsigned int, Node*) { return 0.0f; };
+
+	if (incoming)
+		search(context, CsrGraphIncomingEdges{ graph }, (unsigned int)valid.size(), valid.data(), nodes.data(), isGoal, heuristic);
+	else
+		search(context, CsrGraphEdges{ graph }, (unsigned int)valid.size(), valid.data(), nodes.data(), isGoal, heuristic);
+}
+
+bool Search::bidirectionalAStar(const CsrGraph& graph, SearchContext& context,
+								unsigned int start, unsigned int end, std::vector<unsigned int>& path,
+								IndexHeuristicCheck heuristic) {
+
+	path.clear();
+
+	// like aStar, a path needs at least one step
+	if (start >= graph.getNodeCount() ||
+		end >= graph.getNodeCount() ||
+		start == end)
+		return false;
 
-					// include heuristic and final cost
-					target->hScore = heuristic(target, end);
-					target->fScore = target->gScore + target->hScore;
+	if (context.m_reverse == nullptr)
+		context.m_reverse.reset(new SearchContext());
 
-					openList.push_back(target);
-				}
-				else if (gScore < target->gScore) {
-					target->gScore = gScore;
+	SearchContext& forward = context;
+	SearchContext& backward = *context.m_reverse;
 
-					// update final cost
-					target->fScore = target->gScore + target->hScore;
+	forward.begin(graph.getNodeCount());
+	backward.begin(graph.getNodeCount());
 
-					target->previous = current;
-				}
+	// each front is guided by the average of the two heuristics, half
+	// towards its own goal and half away from the other front's start.
+	// The forward and backward heuristics then sum to zero at every node,
+	// which keeps them consistent with each other so the search can stop
+	// as soon as the two open lists together can't beat the best meeting
+	auto potential = [&](unsigned int n) {
+		return (heuristic(n, end) - heuristic(start, n)) * 0.5f;
+	};
+
+	bool reached = false;
+
+	auto& startRecord = forward.visit(start, nullptr, reached);
+	startRecord.gScore = 0;
+	startRecord.hScore = potential(start);
+	startRecord.fScore = startRecord.hScore;
+	forward.push(start);
+
+	auto& endRecord = backward.visit(end, nullptr, reached);
+	endRecord.gScore = 0;
+	endRecord.hScore = -potential(end);
+	endRecord.fScore = endRecord.hScore;
+	backward.push(end);
+
+	// the cheapest route joining the two fronts so far
+	float best = std::numeric_limits<float>::max();
+	unsigned int meeting = INVALID_INDEX;
+
+	// expands the best node of one front, checking each node it reaches
+	// against the other front for a cheaper meeting
+	auto expand = [&](SearchContext& front, SearchContext& other, bool isForward) {
+
+		unsigned int current = front.pop();
+
+		auto& currentRecord = front.m_records[current];
+		currentRecord.closed = true;
+		float currentG = currentRecord.gScore;
+
+		auto first = isForward ? graph.edgesBegin(current) : graph.incomingBegin(current);
+		auto last = isForward ? graph.edgesEnd(current) : graph.incomingEnd(current);
+
+		for (auto edge = first; edge != last; ++edge) {
+
+			float gScore = currentG + edge->cost;
+
+			auto& record = front.visit(edge->target, nullptr, reached);
+
+			if (reached == false) {
+				record.previous = current;
+				record.gScore = gScore;
+				record.hScore = isForward ? potential(edge->target) : -potential(edge->target);
+				record.fScore = record.gScore + record.hScore;
+
+				front.push(edge->target);
+			}
+			else if (record.closed == false &&
+					 gScore < record.gScore) {
+				record.gScore = gScore;
+				record.fScore = record.gScore + record.hScore;
+				record.previous = current;
+
+				front.decrease(edge->target);
+			}
+			else
+				continue;
+
+			float otherG, otherF;
+			unsigned int otherPrevious;
+			if (other.getScores(edge->target, otherG, otherF, otherPrevious) &&
+				gScore + otherG < best) {
+				best = gScore + otherG;
+				meeting = edge->target;
 			}
 		}
+	};
+
+	while (forward.m_open.empty() == false &&
+		   backward.m_open.empty() == false) {
+
+		// any route cheaper than best would have to leave the forward
+		// open list and then reach the backward one, and with the
+		// heuristics cancelling out it costs at least the sum of the
+		// lowest fScores
+		float forwardMin = forward.m_records[forward.m_open.front()].fScore;
+		float backwardMin = backward.m_records[backward.m_open.front()].fScore;
+		if (forwardMin + backwardMin >= best)
+			break;
+
+		// grow whichever front is smaller
+		if (forward.m_open.size() <= backward.m_open.size())
+			expand(forward, backward, true);
+		else
+			expand(backward, forward, false);
 	}
 
-	// did we find a path?
-	if (end->previous != nullptr) {
-		// path found!
-		while (end != nullptr) {
-			path.push_front(end);
-			end = end->previous;
-		}
+	forward.m_expandedCount += backward.m_expandedCount;
 
-		return true;
+	if (meeting == INVALID_INDEX)
+		return false;
+
+	// walk back to the start from the meeting, then on to the end
+	for (unsigned int index = meeting; index != INVALID_INDEX; index = forward.m_records[index].previous)
+		path.push_back(index);
+
+	std::reverse(path.begin(), path.end());
+
+	for (unsigned int index = backward.m_records[meeting].previous; index != INVALID_INDEX; index = backward.m_records[index].previous)
+		path.push_back(index);
+
+	return true;
+}
+
+bool Search::jumpPointSearch(const Grid& grid, SearchContext& context,
+							 int startX, int startY, int endX, int endY,
+							 std::vector<unsigned int>& path) {
+
+	path.clear();
+
+	if (grid.isWalkable(startX, startY) == false ||
+		grid.isWalkable(endX, endY) == false)
+		return false;
+
+	context.begin(grid.getCellCount());
+
+	unsigned int start = grid.getIndex(startX, startY);
+	unsigned int end = grid.getIndex(endX, endY);
+
+	unsigned int found = search(context, JumpPointEdges{ grid, context, endX, endY }, start, nullptr,
+								[end](unsigned int n, Node*) { return n == end; },
+								[&grid, endX, endY](unsigned int n, Node*) {
+									return Grid::octileDistance(n % grid.getWidth(), n / grid.getWidth(), endX, endY);
+								});
+
+	std::vector<unsigned int> jumpPoints;
+	if (buildPath(context, found, jumpPoints) == false)
+		return false;
+
+	// fill in the straight and diagonal runs between jump points
+	path.push_back(jumpPoints.front());
+	for (size_t i = 1; i < jumpPoints.size(); ++i) {
+
+		int x = jumpPoints[i - 1] % grid.getWidth();
+		int y = jumpPoints[i - 1] / grid.getWidth();
+		int toX = jumpPoints[i] % grid.getWidth();
+		int toY = jumpPoints[i] / grid.getWidth();
+		int dx = toX > x ? 1 : (toX < x ? -1 : 0);
+		int dy = toY > y ? 1 : (toY < y ? -1 : 0);
+
+		while (x != toX || y != toY) {
+			x += dx;
+			y += dy;
+			path.push_back(grid.getIndex(x, y));
+		}
 	}
 
-	return false;
+	return true;
+}
+
+bool Search::jumpPointSearch(const Grid& grid, SearchContext& context,
+							 int startX, int startY, int endX, int endY,
+							 const std::vector<Node*>& cellNodes, Path& path) {
+
+	path.clear();
+
+	if (cellNodes.size() < (size_t)grid.getCellCount())
+		return false;
+
+	std::vector<unsigned int> cells;
+	if (jumpPointSearch(grid, context, startX, startY, endX, endY, cells) == false)
+		return false;
+
+	for (auto cell : cells)
+		path.pushBack(cellNodes[cell]);
+
+	return true;
 }
 
 } // namespace graph
\ No newline at end of file
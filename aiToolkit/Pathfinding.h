@@ -1,13 +1,41 @@
 #pragma once
 
+#include "Path.h"
+
 #include <vector>
 #include <list>
+#include <memory>
 #include <functional>
+#include <atomic>
 
 namespace graph {
 
 class Node;
 
+// a counter that changes whenever a graph does, so that cached search
+// results can tell when they are out of date. The nodes of a graph share
+// one (see Node::setGraphVersion) so that changing one graph leaves the
+// results for any other graph valid. It must outlive the nodes using it
+class GraphVersion {
+public:
+
+	GraphVersion() : m_version(1) {}
+	~GraphVersion() {}
+
+	GraphVersion(const GraphVersion&) = delete;
+	GraphVersion& operator = (const GraphVersion&) = delete;
+
+	unsigned int get() const { return m_version.load(); }
+	void markChanged() { ++m_version; }
+
+	// shared by nodes that haven't been given a graph version of their own
+	static GraphVersion& getDefault();
+
+private:
+
+	std::atomic<unsigned int>	m_version;
+};
+
 // a one-way link to a node with a cost
 class Edge {
 public:
@@ -18,10 +46,18 @@ public:
 		RIVER = (1 << 1),
 	};
 
-	Edge() : target(nullptr), cost(0), flags(0) {}
-	Edge(Node* t, float c) : target(t), cost(c), flags(0) {}
+	Edge() : source(nullptr), target(nullptr), cost(0), flags(0) {}
+	Edge(Node* t, float c) : source(nullptr), target(t), cost(c), flags(0) {}
 	virtual ~Edge() {}
 
+	// change the edge and bump the version of the source's graph. Edges
+	// added to a node's edges directly rather than with Node::addEdge()
+	// have no source, so bump the target's graph instead
+	void setCost(float c);
+	void setFlags(unsigned int f);
+
+	// the node the edge leaves, set by Node::addEdge()
+	Node* source;
 	Node* target;
 	float cost;
 
@@ -34,18 +70,44 @@ public:
 class Node {
 public:
 
-	Node() : flags(0) {}
-	virtual ~Node() { for (auto e : edges) delete e; }
+	Node();
+	virtual ~Node();
+
+	// nodes own their edges so can't be copied
+	Node(const Node&) = delete;
+	Node& operator = (const Node&) = delete;
 
 	std::vector<Edge*> edges;
 
 	unsigned int flags;
 
-	// search data
+	// search data, written back along the found path by the Search
+	// methods that don't take a SearchContext
 	float hScore;
 	float fScore;
 	float gScore;
 	Node* previous;
+
+	// a dense ID unique to this node while it is alive; IDs are recycled
+	// when nodes are deleted so they stay within [0, getIDCount())
+	unsigned int getID() const { return m_id; }
+
+	// one past the highest ID handed out so far
+	static unsigned int getIDCount();
+
+	// adds or removes an edge and bumps the graph version
+	Edge* addEdge(Node* target, float cost, unsigned int flags = 0);
+	bool removeEdge(Edge* edge);
+
+	// the version of the graph this node is part of. The edge and node
+	// helpers and deleting a node bump it automatically, anything else
+	// that changes the graph should call markGraphChanged(). Nodes use
+	// GraphVersion::getDefault() until given their graph's own version,
+	// and moving a node to another version bumps both
+	GraphVersion& getGraphVersion() const { return *m_version; }
+	void setGraphVersion(GraphVersion* version);
+
+	void markGraphChanged() { m_version->markChanged(); }
 	
 	static bool compareGScore(Node* a, Node* b) {
 		return a->gScore < b->gScore;
@@ -54,29 +116,205 @@ public:
 	static bool compareFScore(Node* a, Node* b) {
 		return a->fScore < b->fScore;
 	}
+
+private:
+
+	unsigned int m_id;
+
+	GraphVersion* m_version;
+};
+
+// used for indices that don't refer to a node
+const unsigned int INVALID_INDEX = 0xffffffff;
+
+class CsrGraph;
+class Grid;
+class HierarchicalGrid;
+class TimeSlicedAStar;
+
+// holds the per-query data for a search (scores, parent links and the
+// open list) indexed by node ID, so that the graph itself is never
+// written to. Each thread can own a context and search the same graph
+// at the same time, as long as nothing modifies the graph meanwhile.
+// The context can be reused for any number of searches and only
+// allocates when the graph has grown since it was last used.
+// When searching a CsrGraph the records are indexed by the CsrGraph's
+// node indices instead.
+class SearchContext {
+public:
+
+	SearchContext() : m_searchID(0), m_expandedCount(0) {}
+	~SearchContext() {}
+
+	// scores for a node from the most recent search, if it reached it.
+	// After a bidirectional search these are the forward scores
+	bool getScores(Node* node, float& gScore, float& fScore, Node*& previous) const;
+	bool getScores(unsigned int index, float& gScore, float& fScore, unsigned int& previous) const;
+
+	// how many nodes the most recent search took off the open list
+	unsigned int getExpandedCount() const { return m_expandedCount; }
+
+private:
+
+	friend class Search;
+	friend class HierarchicalGrid;
+	friend class TimeSlicedAStar;
+
+	struct Record {
+		float gScore;
+		float hScore;
+		float fScore;
+		unsigned int previous;
+
+		// the node when searching a Node graph
+		Node* node;
+
+		// only valid when searchID matches the running search
+		unsigned int searchID;
+		int heapIndex;
+		bool closed;
+	};
+
+	// starts a new search over count indices, invalidating all records
+	void begin(unsigned int count);
+
+	// record for an index, if it has not been reached by the running
+	// search then it is reset first and reached is set false
+	Record& visit(unsigned int index, Node* node, bool& reached);
+
+	// binary min-heap open list ordered by fScore, with each record
+	// storing its position so decrease-key is O(log n)
+	void push(unsigned int index);
+	unsigned int pop();
+	void decrease(unsigned int index);
+	void siftUp(int position);
+	void siftDown(int position);
+
+	unsigned int				m_searchID;
+	std::vector<Record>			m_records;
+	std::vector<unsigned int>	m_open;
+
+	unsigned int				m_expandedCount;
+
+	// the backwards half of bidirectional searches, made when first needed
+	std::unique_ptr<SearchContext>	m_reverse;
 };
 
-// the idea is that the search data stored in Node could potentially move
-// into this struct so that multiple searches can be run on the same graph
-// simultaneously using threading, but for now this is just a container
-// for static methods
+// a container for static search methods. The versions taking a
+// SearchContext are thread-safe, the others share a context per thread
+// and write the search data back into the nodes on the found path
 class Search {
 public:
 
 	// Dijkstra's Shortest Path methods
 	static bool dijkstra(Node* start, Node* end, std::list<Node*>& path);
+	static bool dijkstra(SearchContext& context, Node* start, Node* end, std::list<Node*>& path);
 
 	// will search for the closest node that has all of the requested flags
 	static bool dijkstraFindFlags(Node* start, unsigned int flags, std::list<Node*>& path);
+	static bool dijkstraFindFlags(SearchContext& context, Node* start, unsigned int flags, std::list<Node*>& path);
+
+	// the cheapest path from any of the starts to any of the ends
+	static bool dijkstra(SearchContext& context, const std::vector<Node*>& starts, const std::vector<Node*>& ends, std::list<Node*>& path);
+
+	// scores every node reachable from the nearest of the sources, which
+	// can be read back with the context's getScores()
+	static void dijkstraFlood(SearchContext& context, const std::vector<Node*>& sources);
 
 	// A* methods
 	typedef std::function<float(Node* a, Node* b)> HeuristicCheck;
 
 	static bool aStar(Node* start, Node* end, std::list<Node*>& path, HeuristicCheck heuristic);
+	static bool aStar(SearchContext& context, Node* start, Node* end, std::list<Node*>& path, HeuristicCheck heuristic);
+
+	// edge filters for the templated searches, which only follow edges
+	// that the filter returns true for
+	struct AnyEdge {
+		bool operator () (const Edge*) const { return true; }
+	};
+
+	struct ExcludeFlags {
+		unsigned int flags;
+		bool operator () (const Edge* edge) const { return (edge->flags & flags) == 0; }
+	};
+
+	// A* with the heuristic and edge filter known at compile time, so
+	// both are inlined into the search rather than called through a
+	// std::function for every edge. The heuristic is anything callable
+	// as float(Node* a, Node* b), ideally a lambda or function object
+	// as a function pointer may still be called indirectly.
+	// Defined in SearchLoop.h, the HeuristicCheck versions call these
+	template <typename Heuristic, typename EdgeFilter = AnyEdge>
+	static bool aStar(SearchContext& context, Node* start, Node* end, std::list<Node*>& path, Heuristic heuristic, EdgeFilter filter = EdgeFilter());
+	template <typename Heuristic, typename EdgeFilter = AnyEdge>
+	static bool aStar(SearchContext& context, Node* start, Node* end, Path& path, Heuristic heuristic, EdgeFilter filter = EdgeFilter());
+
+	// versions that fill a contiguous Path, which doesn't allocate
+	// once it has held a path as long
+	static bool dijkstra(SearchContext& context, Node* start, Node* end, Path& path);
+	static bool aStar(SearchContext& context, Node* start, Node* end, Path& path, HeuristicCheck heuristic);
+
+	// versions that search a CsrGraph by node index, filling path with indices
+	typedef std::function<float(unsigned int a, unsigned int b)> IndexHeuristicCheck;
+
+	static bool dijkstra(const CsrGraph& graph, SearchContext& context, unsigned int start, unsigned int end, std::vector<unsigned int>& path);
+	static bool dijkstraFindFlags(const CsrGraph& graph, SearchContext& context, unsigned int start, unsigned int flags, std::vector<unsigned int>& path);
+	static bool aStar(const CsrGraph& graph, SearchContext& context, unsigned int start, unsigned int end, std::vector<unsigned int>& path, IndexHeuristicCheck heuristic);
+
+	// scores every node reachable from the nearest of the sources, or
+	// that can reach the nearest of them if searching incoming edges
+	static void dijkstraFlood(const CsrGraph& graph, SearchContext& context, const std::vector<unsigned int>& sources, bool incoming = false);
+
+	// A* from both ends at once, searching backwards from end along the
+	// CsrGraph's incoming edges until the two fronts can't improve on the
+	// best place they have met. Finds a path as cheap as aStar's and
+	// tends to expand fewer nodes on long searches around obstacles.
+	// The heuristic must be consistent for the path to be optimal, and
+	// the context's expanded count covers both fronts
+	static bool bidirectionalAStar(const CsrGraph& graph, SearchContext& context, unsigned int start, unsigned int end, std::vector<unsigned int>& path, IndexHeuristicCheck heuristic);
+
+	// Jump Point Search over an 8-connected uniform-cost grid, where
+	// diagonal moves are only allowed if both adjacent cells are walkable.
+	// Returns the cell indices of every cell along the path
+	static bool jumpPointSearch(const Grid& grid, SearchContext& context, int startX, int startY, int endX, int endY, std::vector<unsigned int>& path);
+
+	// as above but returns the nodes for each cell, where cellNodes holds
+	// a node for every cell of the grid (nullptr for unwalkable cells)
+	static bool jumpPointSearch(const Grid& grid, SearchContext& context, int startX, int startY, int endX, int endY,
+								const std::vector<Node*>& cellNodes, Path& path);
 
 private:
 
+	friend class HierarchicalGrid;
+	friend class TimeSlicedAStar;
+
 	Search() {}
+
+	// shared search loop for dijkstra and A* from one or more starts,
+	// returning the index of the node accepted by isGoal or INVALID_INDEX
+	template <typename Graph, typename IsGoal, typename Heuristic>
+	static unsigned int search(SearchContext& context, const Graph& graph, unsigned int start, Node* startNode, IsGoal isGoal, Heuristic heuristic);
+	template <typename Graph, typename IsGoal, typename Heuristic>
+	static unsigned int search(SearchContext& context, const Graph& graph, unsigned int startCount, const unsigned int* starts, Node* const* startNodes, IsGoal isGoal, Heuristic heuristic);
+
+	// one step of the search loop, expanding the best open node
+	template <typename Graph, typename Heuristic>
+	static unsigned int expand(SearchContext& context, const Graph& graph, Heuristic heuristic);
+
+	// context used by the methods that don't take one
+	static SearchContext& getThreadContext();
+
+	// walks back from end building the path, returning false if there
+	// was no route found to end
+	static bool buildPath(const SearchContext& context, Node* end, std::list<Node*>& path);
+	static bool buildPath(const SearchContext& context, Node* end, Path& path);
+	static bool buildPath(const SearchContext& context, unsigned int end, std::vector<unsigned int>& path);
+
+	// copies search data from the context into the path nodes
+	static void writeBack(SearchContext& context, const std::list<Node*>& path);
 };
 
-} // namespace graph
\ No newline at end of file
+} // namespace graph
+
+// template definitions
+#include "SearchLoop.h"
\ No newline at end of file
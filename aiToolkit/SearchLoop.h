@@ -0,0 +1,163 @@
+#pragma once
+
+#include "Pathfinding.h"
+
+namespace graph {
+
+// lets the search loop walk the edges of a Node graph by node ID,
+// skipping any edge the filter rejects
+template <typename EdgeFilter = Search::AnyEdge>
+struct NodeGraphEdges {
+
+	EdgeFilter filter;
+
+	template <typename Visit>
+	void forEach(Node* node, unsigned int, Visit visit) const {
+		for (auto edge : node->edges)
+			if (filter(edge))
+				visit(edge->target->getID(), edge->target, edge->cost);
+	}
+};
+
+// takes the node with the lowest fScore off the open list, closes it
+// and scores its neighbours, returning its index
+template <typename Graph, typename Heuristic>
+unsigned int Search::expand(SearchContext& context, const Graph& graph, Heuristic heuristic) {
+
+	unsigned int current = context.pop();
+
+	// visiting new nodes can grow the records, so copy what we need
+	auto& currentRecord = context.m_records[current];
+	Node* currentNode = currentRecord.node;
+
+	currentRecord.closed = true;
+	float currentG = currentRecord.gScore;
+
+	bool reached = false;
+
+	// add all connections to openList
+	graph.forEach(currentNode, current,
+				  [&](unsigned int target, Node* targetNode, float cost) {
+
+		float gScore = currentG + cost;
+
+		auto& record = context.visit(target, targetNode, reached);
+
+		// first time this search has reached the node
+		if (reached == false) {
+			record.previous = current;
+
+			record.gScore = gScore;
+
+			// include heuristic and final cost
+			record.hScore = heuristic(target, targetNode);
+			record.fScore = record.gScore + record.hScore;
+
+			context.push(target);
+		}
+		// is it still open and is this a shorter route?
+		else if (record.closed == false &&
+				 gScore < record.gScore) {
+			record.gScore = gScore;
+
+			// update final cost
+			record.fScore = record.gScore + record.hScore;
+
+			record.previous = current;
+
+			context.decrease(target);
+		}
+	});
+
+	return current;
+}
+
+// shared search loop for dijkstra and A*, expanding nodes in order of
+// fScore until isGoal accepts one, returning that node's index.
+// dijkstra simply uses a heuristic of 0 so that fScore == gScore.
+// Graph is an adapter with a forEach(Node* node, unsigned int index, visit)
+// method that calls visit(targetIndex, targetNode, cost) for each edge.
+// Every start begins with a gScore of 0, so the search spreads out from
+// whichever start is closest
+template <typename Graph, typename IsGoal, typename Heuristic>
+unsigned int Search::search(SearchContext& context, const Graph& graph,
+							unsigned int startCount, const unsigned int* starts, Node* const* startNodes,
+							IsGoal isGoal, Heuristic heuristic) {
+
+	bool reached = false;
+
+	for (unsigned int i = 0; i < startCount; ++i) {
+
+		auto& startRecord = context.visit(starts[i], startNodes[i], reached);
+
+		// listed twice
+		if (reached)
+			continue;
+
+		startRecord.gScore = 0;
+		startRecord.hScore = heuristic(starts[i], startNodes[i]);
+		startRecord.fScore = startRecord.gScore + startRecord.hScore;
+
+		context.push(starts[i]);
+	}
+
+	// do search
+	while (context.m_open.empty() == false) {
+
+		unsigned int current = context.m_open.front();
+
+		if (isGoal(current, context.m_records[current].node))
+			return current;
+
+		expand(context, graph, heuristic);
+	}
+
+	return INVALID_INDEX;
+}
+
+template <typename Graph, typename IsGoal, typename Heuristic>
+unsigned int Search::search(SearchContext& context, const Graph& graph,
+							unsigned int start, Node* startNode,
+							IsGoal isGoal, Heuristic heuristic) {
+	return search(context, graph, 1, &start, &startNode, isGoal, heuristic);
+}
+
+template <typename Heuristic, typename EdgeFilter>
+bool Search::aStar(SearchContext& context, Node* start, Node* end, std::list<Node*>& path,
+				   Heuristic heuristic, EdgeFilter filter) {
+
+	path.clear();
+
+	if (start == nullptr ||
+		end == nullptr)
+		return false;
+
+	context.begin(Node::getIDCount());
+
+	unsigned int found = search(context, NodeGraphEdges<EdgeFilter>{ filter }, start->getID(), start,
+								[end](unsigned int, Node* n) { return n == end; },
+								[end, &heuristic](unsigned int, Node* n) { return heuristic(n, end); });
+
+	return buildPath(context, found == INVALID_INDEX ? nullptr : end, path);
+}
+
+template <typename Heuristic, typename EdgeFilter>
+bool Search::aStar(SearchContext& context, Node* start, Node* end, Path& path,
+				   Heuristic heuristic, EdgeFilter filter) {
+
+	path.clear();
+
+	if (start == nullptr ||
+		end == nullptr)
+		return false;
+
+	context.begin(Node::getIDCount());
+
+	unsigned int found = search(context, NodeGraphEdges<EdgeFilter>{ filter }, start->getID(), start,
+								[end](unsigned int, Node* n) { return n == end; },
+								[end, &heuristic](unsigned int, Node* n) { return heuristic(n, end); });
+
+	return buildPath(context, found == INVALID_INDEX ? nullptr : end, path);
+}
+
+} // namespace graph
\ No newline at end of file
@@ -0,0 +1,587 @@
+#include "SectorFlowField.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace ai {
+
+typedef std::pair<float, unsigned int> QueueEntry;
+
+static const unsigned int INVALID_NODE = ~0u;
+
+void SectorFlowField::create(int width, int height, int sectorSize, unsigned short cost) {
+
+	m_width = width;
+	m_height = height;
+	m_sectorSize = sectorSize < 1 ? 1 : sectorSize;
+	m_sectorCols = (width + m_sectorSize - 1) / m_sectorSize;
+	m_sectorRows = (height + m_sectorSize - 1) / m_sectorSize;
+
+	m_costs.assign(width * height, cost == 0 ? 1 : cost);
+
+	buildPortals();
+}
+
+void SectorFlowField::getSectorBounds(unsigned int sector, int& x, int& y, int& width, int& height) const {
+
+	x = (sector % m_sectorCols) * m_sectorSize;
+	y = (sector / m_sectorCols) * m_sectorSize;
+	width = std::min(m_sectorSize, m_width - x);
+	height = std::min(m_sectorSize, m_height - y);
+}
+
+void SectorFlowField::getNodeCentre(unsigned int node, int& x, int& y) const {
+
+	auto& portal = m_portals[node / 2];
+	int side = node & 1;
+
+	x = portal.x + portal.dx * (portal.length / 2) + portal.nx * side;
+	y = portal.y + portal.dy * (portal.length / 2) + portal.ny * side;
+}
+
+void SectorFlowField::buildPortals() {
+
+	m_portals.clear();
+	m_goals.clear();
+
+	// walks along one side of a border, making a portal from each run
+	// of cells that are passable on both sides
+	auto scanBorder = [this](int x, int y, int dx, int dy, int nx, int ny, int length) {
+
+		int start = -1;
+
+		for (int i = 0; i <= length; ++i) {
+
+			int cx = x + dx * i;
+			int cy = y + dy * i;
+
+			bool open = i < length &&
+				isPassable(cx, cy) &&
+				isPassable(cx + nx, cy + ny);
+
+			if (open && start < 0)
+				start = i;
+			else if (open == false && start >= 0) {
+
+				Portal portal;
+				portal.x = x + dx * start;
+				portal.y = y + dy * start;
+				portal.dx = dx;
+				portal.dy = dy;
+				portal.nx = nx;
+				portal.ny = ny;
+				portal.length = i - start;
+				portal.sectors[0] = getSector(portal.x, portal.y);
+				portal.sectors[1] = getSector(portal.x + nx, portal.y + ny);
+				m_portals.push_back(portal);
+
+				start = -1;
+			}
+		}
+	};
+
+	for (int sy = 0; sy < m_sectorRows; ++sy) {
+		for (int sx = 0; sx < m_sectorCols; ++sx) {
+
+			int x, y, width, height;
+			getSectorBounds(sy * m_sectorCols + sx, x, y, width, height);
+
+			// borders to the right and above, so each is only scanned once
+			if (sx + 1 < m_sectorCols)
+				scanBorder(x + width - 1, y, 0, 1, 1, 0, height);
+			if (sy + 1 < m_sectorRows)
+				scanBorder(x, y + height - 1, 1, 0, 0, 1, width);
+		}
+	}
+
+	unsigned int nodeCount = (unsigned int)m_portals.size() * 2;
+
+	m_sectorNodes.assign(getSectorCount(), std::vector<unsigned int>());
+	m_links.assign(nodeCount, std::vector<Link>());
+
+	for (unsigned int node = 0; node < nodeCount; ++node)
+		m_sectorNodes[m_portals[node / 2].sectors[node & 1]].push_back(node);
+
+	// link each node to the nodes of its sector it can reach without leaving it
+	std::vector<float> integration;
+
+	for (unsigned int sector = 0; sector < m_sectorNodes.size(); ++sector) {
+
+		int sectorX, sectorY, width, height;
+		getSectorBounds(sector, sectorX, sectorY, width, height);
+
+		for (auto node : m_sectorNodes[sector]) {
+
+			int x, y;
+			getNodeCentre(node, x, y);
+
+			integration.assign(width * height, UNREACHABLE_COST);
+			integration[(y - sectorY) * width + x - sectorX] = 0;
+
+			integrateSector(sector, integration);
+
+			for (auto other : m_sectorNodes[sector]) {
+
+				if (other == node)
+					continue;
+
+				getNodeCentre(other, x, y);
+
+				float cost = integration[(y - sectorY) * width + x - sectorX];
+				if (cost != UNREACHABLE_COST)
+					m_links[node].push_back({ other, cost });
+			}
+		}
+	}
+}
+
+void SectorFlowField::integrateSector(unsigned int sector, std::vector<float>& integration) const {
+
+	int sectorX, sectorY, width, height;
+	getSectorBounds(sector, sectorX, sectorY, width, height);
+
+	const unsigned short* costs = m_costs.data();
+	auto isOpen = [&](int x, int y) {
+		return x >= 0 && y >= 0 && x < width && y < height &&
+			costs[(sectorY + y) * m_width + sectorX + x] != FlowField::IMPASSABLE;
+	};
+
+	m_open.clear();
+	for (unsigned int i = 0; i < integration.size(); ++i)
+		if (integration[i] != UNREACHABLE_COST)
+			m_open.push_back({ integration[i], i });
+
+	std::make_heap(m_open.begin(), m_open.end(), std::greater<QueueEntry>());
+
+	// sectors are small so a binary heap is cheap enough, and unlike
+	// FlowField's bucket queue it copes with seeds of any cost
+	while (m_open.empty() == false) {
+
+		std::pop_heap(m_open.begin(), m_open.end(), std::greater<QueueEntry>());
+		QueueEntry entry = m_open.back();
+		m_open.pop_back();
+
+		unsigned int cell = entry.second;
+		if (entry.first != integration[cell])
+			continue;
+
+		int x = cell % width;
+		int y = cell / width;
+
+		auto relax = [&](int nx, int ny, float multiplier) {
+			unsigned int neighbour = ny * width + nx;
+			float cost = entry.first + costs[(sectorY + ny) * m_width + sectorX + nx] * multiplier;
+			if (cost < integration[neighbour]) {
+				integration[neighbour] = cost;
+				m_open.push_back({ cost, neighbour });
+				std::push_heap(m_open.begin(), m_open.end(), std::greater<QueueEntry>());
+			}
+		};
+
+		bool left = isOpen(x - 1, y);
+		bool right = isOpen(x + 1, y);
+		bool down = isOpen(x, y - 1);
+		bool up = isOpen(x, y + 1);
+
+		if (down) relax(x, y - 1, 1);
+		if (up) relax(x, y + 1, 1);
+		if (left) {
+			relax(x - 1, y, 1);
+			if (down && isOpen(x - 1, y - 1)) relax(x - 1, y - 1, 1.5f);
+			if (up && isOpen(x - 1, y + 1)) relax(x - 1, y + 1, 1.5f);
+		}
+		if (right) {
+			relax(x + 1, y, 1);
+			if (down && isOpen(x + 1, y - 1)) relax(x + 1, y - 1, 1.5f);
+			if (up && isOpen(x + 1, y + 1)) relax(x + 1, y + 1, 1.5f);
+		}
+	}
+}
+
+SectorFlowField::Goal* SectorFlowField::findGoal(int goalX, int goalY) {
+
+	if (isInside(goalX, goalY) == false)
+		return nullptr;
+
+	auto iter = m_goals.find(goalY * m_width + goalX);
+	return iter == m_goals.end() ? nullptr : &iter->second;
+}
+
+const SectorFlowField::Goal* SectorFlowField::findGoal(int goalX, int goalY) const {
+
+	if (isInside(goalX, goalY) == false)
+		return nullptr;
+
+	auto iter = m_goals.find(goalY * m_width + goalX);
+	return iter == m_goals.end() ? nullptr : &iter->second;
+}
+
+bool SectorFlowField::hasGoal(int goalX, int goalY) const {
+	return findGoal(goalX, goalY) != nullptr;
+}
+
+bool SectorFlowField::addGoal(int goalX, int goalY) {
+
+	if (isPassable(goalX, goalY) == false)
+		return false;
+
+	if (hasGoal(goalX, goalY))
+		return true;
+
+	Goal& goal = m_goals[goalY * m_width + goalX];
+	goal.cell = goalY * m_width + goalX;
+	goal.nodeCosts.assign(m_links.size(), UNREACHABLE_COST);
+	goal.nodeParents.assign(m_links.size(), INVALID_NODE);
+	goal.sectors.assign(getSectorCount(), SectorField());
+	goal.generated = 0;
+
+	// the goal's sector gives the cost of leaving through each of its portals
+	unsigned int sector = getSector(goalX, goalY);
+
+	int sectorX, sectorY, width, height;
+	getSectorBounds(sector, sectorX, sectorY, width, height);
+
+	std::vector<float> integration(width * height, UNREACHABLE_COST);
+	integration[(goalY - sectorY) * width + goalX - sectorX] = 0;
+
+	integrateSector(sector, integration);
+
+	std::vector<QueueEntry> open;
+
+	for (auto node : m_sectorNodes[sector]) {
+
+		int x, y;
+		getNodeCentre(node, x, y);
+
+		float cost = integration[(y - sectorY) * width + x - sectorX];
+		if (cost != UNREACHABLE_COST) {
+			goal.nodeCosts[node] = cost;
+			open.push_back({ cost, node });
+		}
+	}
+
+	std::make_heap(open.begin(), open.end(), std::greater<QueueEntry>());
+
+	// then spreads out over the portal graph. As with cells, a node costs
+	// its own cell's cost more than the node it leads to
+	while (open.empty() == false) {
+
+		std::pop_heap(open.begin(), open.end(), std::greater<QueueEntry>());
+		QueueEntry entry = open.back();
+		open.pop_back();
+
+		unsigned int node = entry.second;
+		if (entry.first != goal.nodeCosts[node])
+			continue;
+
+		auto relax = [&](unsigned int other, float cost) {
+			if (cost < goal.nodeCosts[other]) {
+				goal.nodeCosts[other] = cost;
+				goal.nodeParents[other] = node;
+				open.push_back({ cost, other });
+				std::push_heap(open.begin(), open.end(), std::greater<QueueEntry>());
+			}
+		};
+
+		int x, y;
+		getNodeCentre(node ^ 1, x, y);
+
+		relax(node ^ 1, entry.first + getCost(x, y));
+
+		for (auto& link : m_links[node])
+			relax(link.node, entry.first + link.cost);
+	}
+
+	generateSector(goal, sector);
+	++goal.generated;
+
+	return true;
+}
+
+void SectorFlowField::removeGoal(int goalX, int goalY) {
+
+	if (isInside(goalX, goalY))
+		m_goals.erase(goalY * m_width + goalX);
+}
+
+void SectorFlowField::generateSector(Goal& goal, unsigned int sector) {
+
+	SectorField& field = goal.sectors[sector];
+
+	int sectorX, sectorY, width, height;
+	getSectorBounds(sector, sectorX, sectorY, width, height);
+
+	field.integration.assign(width * height, UNREACHABLE_COST);
+	field.flow.assign(width * height, glm::vec3(0));
+
+	// seeds the cells along each portal from the integrated costs on the
+	// far side, if that sector has been made, pointing across in case
+	// nothing in this sector turns out cheaper
+	for (auto node : m_sectorNodes[sector]) {
+
+		auto& portal = m_portals[node / 2];
+		int side = node & 1;
+
+		auto& across = goal.sectors[portal.sectors[side ^ 1]];
+		if (across.integration.empty())
+			continue;
+
+		int acrossX, acrossY, acrossWidth, acrossHeight;
+		getSectorBounds(portal.sectors[side ^ 1], acrossX, acrossY, acrossWidth, acrossHeight);
+
+		int nx = side ? -portal.nx : portal.nx;
+		int ny = side ? -portal.ny : portal.ny;
+
+		for (int i = 0; i < portal.length; ++i) {
+
+			int x = portal.x + portal.dx * i + portal.nx * side;
+			int y = portal.y + portal.dy * i + portal.ny * side;
+
+			float far = across.integration[(y + ny - acrossY) * acrossWidth + x + nx - acrossX];
+			if (far == UNREACHABLE_COST)
+				continue;
+
+			unsigned int cell = (y - sectorY) * width + x - sectorX;
+			float cost = far + getCost(x, y);
+
+			if (cost < field.integration[cell]) {
+				field.integration[cell] = cost;
+				field.flow[cell] = glm::vec3(nx, ny, 0);
+			}
+		}
+	}
+
+	int goalX = goal.cell % m_width;
+	int goalY = goal.cell / m_width;
+
+	if (getSector(goalX, goalY) == (int)sector) {
+		unsigned int cell = (goalY - sectorY) * width + goalX - sectorX;
+		field.integration[cell] = 0;
+		field.flow[cell] = glm::vec3(0);
+	}
+
+	std::vector<float> seeds = field.integration;
+
+	integrateSector(sector, field.integration);
+
+	// then points everything else at its lowest neighbour in the sector,
+	// as FlowField::generateFlow() does
+	const float diagonal = 0.70710678f;
+
+	auto isOpen = [&](int x, int y) {
+		return x >= 0 && y >= 0 && x < width && y < height &&
+			isPassable(sectorX + x, sectorY + y);
+	};
+
+	for (int y = 0; y < height; ++y) {
+		for (int x = 0; x < width; ++x) {
+
+			unsigned int cell = y * width + x;
+			bool passable = isPassable(sectorX + x, sectorY + y);
+
+			// seeds that nothing improved on keep pointing across their portal
+			if (passable &&
+				seeds[cell] != UNREACHABLE_COST &&
+				field.integration[cell] == seeds[cell])
+				continue;
+
+			float lowest = passable ? field.integration[cell] : UNREACHABLE_COST;
+			glm::vec3 flow(0);
+
+			auto sample = [&](int nx, int ny, float dx, float dy) {
+				float cost = field.integration[ny * width + nx];
+				if (cost < lowest) {
+					lowest = cost;
+					flow = glm::vec3(dx, dy, 0);
+				}
+			};
+
+			bool left = isOpen(x - 1, y);
+			bool right = isOpen(x + 1, y);
+			bool down = isOpen(x, y - 1);
+			bool up = isOpen(x, y + 1);
+
+			if (down) sample(x, y - 1, 0, -1);
+			if (up) sample(x, y + 1, 0, 1);
+			if (left) {
+				sample(x - 1, y, -1, 0);
+				if (down && isOpen(x - 1, y - 1)) sample(x - 1, y - 1, -diagonal, -diagonal);
+				if (up && isOpen(x - 1, y + 1)) sample(x - 1, y + 1, -diagonal, diagonal);
+			}
+			if (right) {
+				sample(x + 1, y, 1, 0);
+				if (down && isOpen(x + 1, y - 1)) sample(x + 1, y - 1, diagonal, -diagonal);
+				if (up && isOpen(x + 1, y + 1)) sample(x + 1, y + 1, diagonal, diagonal);
+			}
+
+			field.flow[cell] = flow;
+		}
+	}
+}
+
+SectorFlowField::SectorField& SectorFlowField::generateRoute(Goal& goal, int x, int y) {
+
+	unsigned int sector = getSector(x, y);
+
+	int sectorX, sectorY, width, height;
+	getSectorBounds(sector, sectorX, sectorY, width, height);
+
+	// finds the portal the cell is best off leaving by
+	std::vector<float> integration(width * height, UNREACHABLE_COST);
+	integration[(y - sectorY) * width + x - sectorX] = 0;
+
+	integrateSector(sector, integration);
+
+	unsigned int best = INVALID_NODE;
+	float bestCost = UNREACHABLE_COST;
+
+	for (auto node : m_sectorNodes[sector]) {
+
+		if (goal.nodeCosts[node] == UNREACHABLE_COST)
+			continue;
+
+		int nodeX, nodeY;
+		getNodeCentre(node, nodeX, nodeY);
+
+		float cost = integration[(nodeY - sectorY) * width + nodeX - sectorX];
+		if (cost != UNREACHABLE_COST &&
+			cost + goal.nodeCosts[node] < bestCost) {
+			best = node;
+			bestCost = cost + goal.nodeCosts[node];
+		}
+	}
+
+	// then makes each sector along the route, working back from the goal.
+	// A sector already made is made again if the route passes through a
+	// part of it that had no way out when it was made
+	std::vector<unsigned int> route;
+	for (unsigned int node = best; node != INVALID_NODE; node = goal.nodeParents[node])
+		route.push_back(node);
+
+	for (auto iter = route.rbegin(); iter != route.rend(); ++iter) {
+
+		unsigned int routeSector = m_portals[*iter / 2].sectors[*iter & 1];
+		auto& field = goal.sectors[routeSector];
+
+		int nodeX, nodeY, routeX, routeY, routeWidth, routeHeight;
+		getNodeCentre(*iter, nodeX, nodeY);
+		getSectorBounds(routeSector, routeX, routeY, routeWidth, routeHeight);
+
+		if (field.integration.empty()) {
+			generateSector(goal, routeSector);
+			++goal.generated;
+		}
+		else if (field.integration[(nodeY - routeY) * routeWidth + nodeX - routeX] == UNREACHABLE_COST)
+			generateSector(goal, routeSector);
+	}
+
+	auto& field = goal.sectors[sector];
+
+	if (field.integration.empty()) {
+		generateSector(goal, sector);
+		++goal.generated;
+	}
+	else if (best != INVALID_NODE)
+		generateSector(goal, sector);
+
+	return field;
+}
+
+bool SectorFlowField::generatePath(int goalX, int goalY, int x, int y) {
+
+	if (isPassable(x, y) == false ||
+		addGoal(goalX, goalY) == false)
+		return false;
+
+	return findField(*findGoal(goalX, goalY), x, y) != nullptr;
+}
+
+SectorFlowField::SectorField* SectorFlowField::findField(Goal& goal, int x, int y) {
+
+	SectorField* field = &goal.sectors[getSector(x, y)];
+
+	int sectorX, sectorY, width, height;
+	getSectorBounds(getSector(x, y), sectorX, sectorY, width, height);
+
+	unsigned int cell = (y - sectorY) * width + x - sectorX;
+
+	// impassable cells only need their sector made to point out of them
+	if (isPassable(x, y) == false) {
+		if (field->integration.empty())
+			field = &generateRoute(goal, x, y);
+		return field;
+	}
+
+	if (field->integration.empty() == false &&
+		field->integration[cell] != UNREACHABLE_COST)
+		return field;
+
+	if (field->unreachable.empty() == false &&
+		field->unreachable[cell])
+		return nullptr;
+
+	field = &generateRoute(goal, x, y);
+
+	// the route is the best the portal graph has, so
+	// routing from the cell again won't find a way either
+	if (field->integration[cell] == UNREACHABLE_COST) {
+		if (field->unreachable.empty())
+			field->unreachable.assign(width * height, false);
+		field->unreachable[cell] = true;
+		return nullptr;
+	}
+
+	return field;
+}
+
+const glm::vec3& SectorFlowField::getFlow(int goalX, int goalY, int x, int y) {
+
+	static const glm::vec3 none(0);
+
+	if (isInside(x, y) == false ||
+		addGoal(goalX, goalY) == false)
+		return none;
+
+	SectorField* field = findField(*findGoal(goalX, goalY), x, y);
+	if (field == nullptr)
+		return none;
+
+	int sectorX, sectorY, width, height;
+	getSectorBounds(getSector(x, y), sectorX, sectorY, width, height);
+
+	return field->flow[(y - sectorY) * width + x - sectorX];
+}
+
+float SectorFlowField::getIntegration(int goalX, int goalY, int x, int y) {
+
+	if (isInside(x, y) == false ||
+		addGoal(goalX, goalY) == false)
+		return UNREACHABLE_COST;
+
+	SectorField* field = findField(*findGoal(goalX, goalY), x, y);
+	if (field == nullptr)
+		return UNREACHABLE_COST;
+
+	int sectorX, sectorY, width, height;
+	getSectorBounds(getSector(x, y), sectorX, sectorY, width, height);
+
+	return field->integration[(y - sectorY) * width + x - sectorX];
+}
+
+bool SectorFlowField::isSectorGenerated(int goalX, int goalY, int sector) const {
+
+	const Goal* goal = findGoal(goalX, goalY);
+
+	return goal != nullptr &&
+		sector >= 0 &&
+		sector < getSectorCount() &&
+		goal->sectors[sector].integration.empty() == false;
+}
+
+unsigned int SectorFlowField::getGeneratedSectorCount(int goalX, int goalY) const {
+
+	const Goal* goal = findGoal(goalX, goalY);
+	return goal == nullptr ? 0 : goal->generated;
+}
+
+} // namespace ai
\ No newline at end of file
@@ -0,0 +1,169 @@
+#pragma once
+
+#include "FlowField.h"
+#include <unordered_map>
+
+namespace ai {
+
+// a flow field split into square sectors, in the style of Supreme Commander 2.
+// Wherever a sector border can be crossed a portal joins the two sectors,
+// and the portals form a small graph that is searched from each goal to
+// find the route to it from every portal. Sector flow is only made when
+// something asks for it: the sectors along the portal route from that
+// cell are integrated one at a time working back from the goal, each
+// carrying on from the costs along the borders of the sectors made before
+// it. So memory and time grow with the sectors agents cross rather than
+// with the size of the map. Fields are kept per goal until the goal is
+// removed or the portals are rebuilt.
+// A sector only carries on from sectors that were made before it, so its
+// flow can be longer than the best route if a better way through later
+// sectors turns up, but it always leads to the goal.
+// Moves and costs are as FlowField::integrate()
+class SectorFlowField {
+public:
+
+	enum {
+		DEFAULT_SECTOR_SIZE = 10,
+	};
+
+	SectorFlowField() : m_width(0), m_height(0), m_sectorSize(0), m_sectorCols(0), m_sectorRows(0) {}
+	SectorFlowField(int width, int height, int sectorSize = DEFAULT_SECTOR_SIZE, unsigned short cost = FlowField::WALKABLE) {
+		create(width, height, sectorSize, cost);
+	}
+	~SectorFlowField() {}
+
+	// sets every cell to cost, builds the portals and forgets every goal
+	void create(int width, int height, int sectorSize = DEFAULT_SECTOR_SIZE, unsigned short cost = FlowField::WALKABLE);
+
+	int getWidth() const { return m_width; }
+	int getHeight() const { return m_height; }
+	int getSectorSize() const { return m_sectorSize; }
+	int getSectorCount() const { return m_sectorCols * m_sectorRows; }
+	int getSector(int x, int y) const { return (y / m_sectorSize) * m_sectorCols + x / m_sectorSize; }
+
+	bool isInside(int x, int y) const {
+		return x >= 0 && y >= 0 && x < m_width && y < m_height;
+	}
+
+	// cells outside of the field are impassable
+	unsigned short getCost(int x, int y) const {
+		return isInside(x, y) ? m_costs[y * m_width + x] : (unsigned short)FlowField::IMPASSABLE;
+	}
+	bool isPassable(int x, int y) const { return getCost(x, y) != FlowField::IMPASSABLE; }
+
+	// costs must be at least 1, or IMPASSABLE. Call buildPortals() after
+	// changing costs
+	void setCost(int x, int y, unsigned short cost) { m_costs[y * m_width + x] = cost == 0 ? 1 : cost; }
+
+	// finds the portals and their costs across each sector, forgetting every goal
+	void buildPortals();
+
+	// searches the portal graph from a goal and makes the goal's sector,
+	// returning false if the goal is impassable or off the field. Goals
+	// are added on first use by the calls below, but adding them first
+	// keeps the search out of the agents' update
+	bool addGoal(int goalX, int goalY);
+	void removeGoal(int goalX, int goalY);
+	void clearGoals() { m_goals.clear(); }
+
+	bool hasGoal(int goalX, int goalY) const;
+
+	// makes every sector an agent at x, y would cross on its way to the goal
+	bool generatePath(int goalX, int goalY, int x, int y);
+
+	// the direction to move in from a cell towards a goal, making the
+	// cell's sector if it hasn't been made yet. 0 if there is no way to the goal
+	const glm::vec3& getFlow(int goalX, int goalY, int x, int y);
+
+	// the integrated cost of a cell, UNREACHABLE_COST if there is no way
+	// to the goal. Also makes the sector
+	float getIntegration(int goalX, int goalY, int x, int y);
+
+	// true if a sector has already been made for a goal
+	bool isSectorGenerated(int goalX, int goalY, int sector) const;
+	unsigned int getGeneratedSectorCount(int goalX, int goalY) const;
+
+	unsigned int getPortalCount() const { return (unsigned int)m_portals.size(); }
+
+protected:
+
+	// a run of cells along a sector border that can be crossed. Side 0
+	// is the sector to the left or below, side 1 is a cell along the normal
+	struct Portal {
+		int				x, y;
+		int				dx, dy;		// along the border
+		int				nx, ny;		// across the border, from side 0 to side 1
+		int				length;
+		unsigned int	sectors[2];
+	};
+
+	// each side of each portal is a node in the portal graph, numbered
+	// portal * 2 + side, linked to the node on the other side and to the
+	// nodes of its sector it can reach
+	struct Link {
+		unsigned int	node;
+		float			cost;
+	};
+
+	struct SectorField {
+		std::vector<float>		integration;
+		std::vector<glm::vec3>	flow;
+
+		// passable cells already found to have no way to the goal, so they
+		// aren't routed again. Empty until one is found, and only cleared
+		// with the goal, as that is when costs can change
+		std::vector<bool>		unreachable;
+	};
+
+	struct Goal {
+		unsigned int				cell;
+		std::vector<float>			nodeCosts;		// measured between portal centres, so approximate
+		std::vector<unsigned int>	nodeParents;	// next node towards the goal
+		std::vector<SectorField>	sectors;
+		unsigned int				generated;
+	};
+
+	// the cell of a node nearest the middle of its portal
+	void getNodeCentre(unsigned int node, int& x, int& y) const;
+
+	// the first cell and size of a sector, which is smaller along the far edges
+	void getSectorBounds(unsigned int sector, int& x, int& y, int& width, int& height) const;
+
+	// integrates a single sector, indexed from its first cell. Cells given
+	// a cost other than UNREACHABLE_COST are the seeds it spreads out from
+	void integrateSector(unsigned int sector, std::vector<float>& integration) const;
+
+	// integrates a sector of a goal out from the goal and the borders of
+	// the goal's sectors made so far. Making a sector again only ever
+	// lowers its costs, so flow made earlier still leads downhill
+	void generateSector(Goal& goal, unsigned int sector);
+
+	// makes the sectors along the portal route from a cell to the goal,
+	// returning the cell's sector
+	SectorField& generateRoute(Goal& goal, int x, int y);
+
+	// the sector a cell is in, making it and the route from it if the cell
+	// can't reach the goal yet. Null if a passable cell can't reach the
+	// goal, which is remembered so that asking again is cheap
+	SectorField* findField(Goal& goal, int x, int y);
+
+	Goal* findGoal(int goalX, int goalY);
+	const Goal* findGoal(int goalX, int goalY) const;
+
+	int		m_width, m_height;
+	int		m_sectorSize;
+	int		m_sectorCols, m_sectorRows;
+
+	std::vector<unsigned short>	m_costs;
+
+	std::vector<Portal>						m_portals;
+	std::vector<std::vector<Link>>			m_links;
+	std::vector<std::vector<unsigned int>>	m_sectorNodes;
+
+	std::unordered_map<unsigned int, Goal>	m_goals;
+
+	// scratch space for integrating a sector, sized to one sector
+	mutable std::vector<std::pair<float, unsigned int>>	m_open;
+};
+
+} // namespace ai
\ No newline at end of file
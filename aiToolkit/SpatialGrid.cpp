@@ -0,0 +1,92 @@
+#include "SpatialGrid.h"
+#include "Agent.h"
+#include "AgentStore.h"
+
+namespace ai {
+
+void SpatialGrid::build(std::vector<Agent>& agents) {
+
+	m_agents = agents.data();
+	m_count = (unsigned int)agents.size();
+	m_entries.resize(m_count);
+
+	for (unsigned int i = 0; i < m_count; ++i) {
+
+		Entry& entry = m_entries[i];
+		entry.position = agents[i].getPosition();
+		entry.index = i;
+
+		glm::vec3* velocity = nullptr;
+		entry.velocity = agents[i].getBlackboard().get("velocity", &velocity) && velocity != nullptr ? *velocity : glm::vec3(0);
+	}
+
+	sort();
+}
+
+void SpatialGrid::build(const AgentStore& store) {
+
+	m_agents = nullptr;
+	m_count = store.getCount();
+	m_entries.resize(m_count);
+
+	const float* positionX = store.getComponent(POSITION_X);
+	const float* positionY = store.getComponent(POSITION_Y);
+	const float* positionZ = store.getComponent(POSITION_Z);
+	const float* velocityX = store.getComponent(VELOCITY_X);
+	const float* velocityY = store.getComponent(VELOCITY_Y);
+	const float* velocityZ = store.getComponent(VELOCITY_Z);
+
+	for (unsigned int i = 0; i < m_count; ++i) {
+
+		Entry& entry = m_entries[i];
+		entry.position = glm::vec3(positionX[i], positionY[i], positionZ[i]);
+		entry.velocity = glm::vec3(velocityX[i], velocityY[i], velocityZ[i]);
+		entry.index = i;
+	}
+
+	sort();
+}
+
+void SpatialGrid::sort() {
+
+	// around two buckets per agent keeps collisions down
+	unsigned int bucketCount = 16;
+	while (bucketCount < m_count * 2)
+		bucketCount *= 2;
+
+	m_mask = bucketCount - 1;
+	m_starts.assign(bucketCount + 1, 0);
+	m_buckets.resize(m_count);
+
+	// count the agents in each bucket, then sort them by starting
+	// each bucket where the ones before it finish
+	for (unsigned int i = 0; i < m_count; ++i) {
+
+		auto& position = m_entries[i].position;
+		m_buckets[i] = getBucket(getCell(position.x), getCell(position.y));
+		++m_starts[m_buckets[i] + 1];
+	}
+
+	for (unsigned int bucket = 0; bucket < bucketCount; ++bucket)
+		m_starts[bucket + 1] += m_starts[bucket];
+
+	std::vector<unsigned int> next(m_starts.begin(), m_starts.end() - 1);
+
+	m_unsorted.swap(m_entries);
+	m_entries.resize(m_count);
+
+	for (unsigned int i = 0; i < m_count; ++i)
+		m_entries[next[m_buckets[i]]++] = m_unsorted[i];
+}
+
+unsigned int SpatialGrid::getIndex(const Agent* agent) const {
+
+	if (m_agents == nullptr ||
+		agent < m_agents ||
+		agent >= m_agents + m_count)
+		return INVALID_INDEX;
+
+	return (unsigned int)(agent - m_agents);
+}
+
+} // namespace ai
\ No newline at end of file
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <cmath>
+
+namespace ai {
+
+class Agent;
+class AgentStore;
+
+// a spatial hash of agents for finding neighbours within a radius without
+// testing every agent. Cells are square columns in x and y hashed into a
+// table, so the world needs no bounds; z is only used in the distance test.
+// build() takes a copy of every agent's position and velocity, sorted by
+// cell, so it should be rebuilt once per update before the agents move,
+// and queries see where agents were when it was built.
+// Cells the size of the query radius give the fewest tests
+class SpatialGrid {
+public:
+
+	struct Entry {
+		glm::vec3		position;
+		glm::vec3		velocity;
+		unsigned int	index;		// into the agents it was built from
+	};
+
+	enum : unsigned int {
+		INVALID_INDEX = 0xffffffff,
+	};
+
+	SpatialGrid(float cellSize = 100) : m_cellSize(cellSize), m_agents(nullptr), m_count(0), m_mask(0) {}
+	~SpatialGrid() {}
+
+	void setCellSize(float cellSize) { m_cellSize = cellSize; }
+	float getCellSize() const { return m_cellSize; }
+
+	// copies the agents' positions and velocities (from the "velocity"
+	// blackboard entry, or 0 if they have none) into the grid
+	void build(std::vector<Agent>& agents);
+
+	// copies the positions and velocities of the agents in a store, with
+	// each entry's index the agent's index in the store. getIndex() only
+	// finds Agents, so it returns INVALID_INDEX for a grid built this way
+	void build(const AgentStore& store);
+
+	unsigned int getCount() const { return m_count; }
+
+	// the index of an agent in the agents the grid was built from
+	unsigned int getIndex(const Agent* agent) const;
+
+	// calls visit(entry, distanceSqr) for every agent closer than radius
+	// to position, including an agent at the position itself
+	template <typename Visitor>
+	void query(const glm::vec3& position, float radius, Visitor visit) const;
+
+protected:
+
+	int getCell(float v) const { return (int)std::floor(v / m_cellSize); }
+
+	// sorts m_entries, filled in with every agent in order, by bucket
+	void sort();
+
+	unsigned int getBucket(int x, int y) const {
+		return ((unsigned int)x * 73856093u ^ (unsigned int)y * 19349663u) & m_mask;
+	}
+
+	float	m_cellSize;
+
+	const Agent*	m_agents;
+	unsigned int	m_count;
+
+	// entries sorted by bucket, with the first entry of each bucket in
+	// m_starts and one past the last in the next bucket's start
+	unsigned int				m_mask;
+	std::vector<unsigned int>	m_starts;
+	std::vector<Entry>			m_entries;
+	std::vector<unsigned int>	m_buckets;
+	std::vector<Entry>			m_unsorted;
+};
+
+template <typename Visitor>
+void SpatialGrid::query(const glm::vec3& position, float radius, Visitor visit) const {
+
+	if (m_count == 0)
+		return;
+
+	float radiusSqr = radius * radius;
+
+	auto search = [&](unsigned int bucket) {
+		for (unsigned int i = m_starts[bucket]; i < m_starts[bucket + 1]; ++i) {
+			auto diff = m_entries[i].position - position;
+			float distanceSqr = glm::dot(diff, diff);
+			if (distanceSqr < radiusSqr)
+				visit(m_entries[i], distanceSqr);
+		}
+	};
+
+	int minX = getCell(position.x - radius), maxX = getCell(position.x + radius);
+	int minY = getCell(position.y - radius), maxY = getCell(position.y + radius);
+
+	// different cells can share a bucket, so buckets already searched are
+	// skipped. Past a handful of cells it is simpler to test everything
+	const int MAX_CELLS = 64;
+	if ((maxX - minX + 1) * (maxY - minY + 1) > MAX_CELLS) {
+		for (unsigned int bucket = 0; bucket <= m_mask; ++bucket)
+			search(bucket);
+		return;
+	}
+
+	unsigned int searched[MAX_CELLS];
+	int searchedCount = 0;
+
+	for (int y = minY; y <= maxY; ++y) {
+		for (int x = minX; x <= maxX; ++x) {
+
+			unsigned int bucket = getBucket(x, y);
+
+			bool seen = false;
+			for (int i = 0; i < searchedCount && seen == false; ++i)
+				seen = searched[i] == bucket;
+
+			if (seen == false) {
+				searched[searchedCount++] = bucket;
+				search(bucket);
+			}
+		}
+	}
+}
+
+} // namespace ai
\ No newline at end of file
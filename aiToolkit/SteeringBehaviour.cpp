@@ -3,7 +3,19 @@
 #include "Blackboard.h"
 #include "Timing.h"
 #include "Geometry.h"
+#include "SectorFlowField.h"
+#include "FlowFieldCache.h"
+#include "SpatialGrid.h"
+#include "AgentStore.h"
 #include <glm/ext.hpp>
+#include <atomic>
+#include <cassert>
+
+#if defined(STEERING_AVX)
+#include <immintrin.h>
+#elif defined(STEERING_SSE)
+#include <emmintrin.h>
+#endif
 
 namespace ai {
 
@@ -59,10 +71,184 @@ void SteeringState::update(Agent* entity) {
 	entity->translate(*velocity * app::Time::deltaTime());
 }
 
+void SteeringForce::accumulateForces(AgentStore& store, float weight,
+									 float* forceX, float* forceY, float* forceZ) const {
+
+	// one stand-in reused for every agent, with its limits only
+	// set again when they change as agents mostly share them
+	Agent agent;
+	glm::vec3 velocity(0);
+	float maxForce = 0, maxVelocity = 0;
+	agent.getBlackboard().set("velocity", &velocity);
+	agent.getBlackboard().set("maxForce", maxForce);
+	agent.getBlackboard().set("maxVelocity", maxVelocity);
+
+	unsigned int count = store.getCount();
+
+	for (unsigned int i = 0; i < count; ++i) {
+
+		AgentView view = store.getAgent(i);
+
+		agent.setPosition(view.getPosition());
+		velocity = view.getVelocity();
+
+		if (view.getMaxForce() != maxForce) {
+			maxForce = view.getMaxForce();
+			agent.getBlackboard().set("maxForce", maxForce);
+		}
+		if (view.getMaxVelocity() != maxVelocity) {
+			maxVelocity = view.getMaxVelocity();
+			agent.getBlackboard().set("maxVelocity", maxVelocity);
+		}
+
+		glm::vec3 force = getForce(&agent) * weight;
+
+		forceX[i] += force.x;
+		forceY[i] += force.y;
+		forceZ[i] += force.z;
+	}
+}
+
+void SteeringSystem::update(float deltaTime) {
+
+	if (m_store == nullptr)
+		return;
+
+	unsigned int count = m_store->getCount();
+
+	m_forceX.assign(count, 0);
+	m_forceY.assign(count, 0);
+	m_forceZ.assign(count, 0);
+
+	// accumulate forces
+	for (auto& wf : m_forces)
+		wf.force->accumulateForces(*m_store, wf.weight, m_forceX.data(), m_forceY.data(), m_forceZ.data());
+
+	float* positionX = m_store->getComponent(POSITION_X);
+	float* positionY = m_store->getComponent(POSITION_Y);
+	float* positionZ = m_store->getComponent(POSITION_Z);
+	float* velocityX = m_store->getComponent(VELOCITY_X);
+	float* velocityY = m_store->getComponent(VELOCITY_Y);
+	float* velocityZ = m_store->getComponent(VELOCITY_Z);
+	const float* maxVelocity = m_store->getComponent(MAX_VELOCITY);
+
+	for (unsigned int i = 0; i < count; ++i) {
+
+		velocityX[i] += m_forceX[i] * deltaTime;
+		velocityY[i] += m_forceY[i] * deltaTime;
+		velocityZ[i] += m_forceZ[i] * deltaTime;
+
+		// cap velocity
+		float speedSqr = velocityX[i] * velocityX[i] + velocityY[i] * velocityY[i] + velocityZ[i] * velocityZ[i];
+		if (speedSqr > maxVelocity[i] * maxVelocity[i]) {
+			float scale = maxVelocity[i] / std::sqrt(speedSqr);
+			velocityX[i] *= scale;
+			velocityY[i] *= scale;
+			velocityZ[i] *= scale;
+		}
+
+		positionX[i] += velocityX[i] * deltaTime;
+		positionY[i] += velocityY[i] * deltaTime;
+		positionZ[i] += velocityZ[i] * deltaTime;
+	}
+}
+
+// adds a force of maxForce towards a point for every agent in a
+// store, or away from it if the weight is negative
+static void accumulateTowards(AgentStore& store, const glm::vec3& target, float weight,
+							  float* forceX, float* forceY, float* forceZ) {
+
+	unsigned int count = store.getCount();
+
+	const float* positionX = store.getComponent(POSITION_X);
+	const float* positionY = store.getComponent(POSITION_Y);
+	const float* positionZ = store.getComponent(POSITION_Z);
+	const float* maxForce = store.getComponent(MAX_FORCE);
+
+	unsigned int i = 0;
+
+	// lanes at the target divide by 0 and are then masked out
+#if defined(STEERING_AVX)
+
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 targetX = _mm256_set1_ps(target.x);
+	const __m256 targetY = _mm256_set1_ps(target.y);
+	const __m256 targetZ = _mm256_set1_ps(target.z);
+	const __m256 weights = _mm256_set1_ps(weight);
+
+	for (; i + 8 <= count; i += 8) {
+
+		__m256 x = _mm256_sub_ps(targetX, _mm256_loadu_ps(positionX + i));
+		__m256 y = _mm256_sub_ps(targetY, _mm256_loadu_ps(positionY + i));
+		__m256 z = _mm256_sub_ps(targetZ, _mm256_loadu_ps(positionZ + i));
+
+		__m256 scale = _mm256_mul_ps(_mm256_loadu_ps(maxForce + i), weights);
+		__m256 distanceSqr = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)), _mm256_mul_ps(z, z));
+		__m256 away = _mm256_cmp_ps(distanceSqr, zero, _CMP_GT_OQ);
+		__m256 normalised = _mm256_div_ps(scale, _mm256_sqrt_ps(distanceSqr));
+		scale = _mm256_or_ps(_mm256_and_ps(away, normalised), _mm256_andnot_ps(away, scale));
+
+		_mm256_storeu_ps(forceX + i, _mm256_add_ps(_mm256_loadu_ps(forceX + i), _mm256_mul_ps(x, scale)));
+		_mm256_storeu_ps(forceY + i, _mm256_add_ps(_mm256_loadu_ps(forceY + i), _mm256_mul_ps(y, scale)));
+		_mm256_storeu_ps(forceZ + i, _mm256_add_ps(_mm256_loadu_ps(forceZ + i), _mm256_mul_ps(z, scale)));
+	}
+
+#elif defined(STEERING_SSE)
+
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 targetX = _mm_set1_ps(target.x);
+	const __m128 targetY = _mm_set1_ps(target.y);
+	const __m128 targetZ = _mm_set1_ps(target.z);
+	const __m128 weights = _mm_set1_ps(weight);
+
+	for (; i + 4 <= count; i += 4) {
+
+		__m128 x = _mm_sub_ps(targetX, _mm_loadu_ps(positionX + i));
+		__m128 y = _mm_sub_ps(targetY, _mm_loadu_ps(positionY + i));
+		__m128 z = _mm_sub_ps(targetZ, _mm_loadu_ps(positionZ + i));
+
+		__m128 scale = _mm_mul_ps(_mm_loadu_ps(maxForce + i), weights);
+		__m128 distanceSqr = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+		__m128 away = _mm_cmpgt_ps(distanceSqr, zero);
+		__m128 normalised = _mm_div_ps(scale, _mm_sqrt_ps(distanceSqr));
+		scale = _mm_or_ps(_mm_and_ps(away, normalised), _mm_andnot_ps(away, scale));
+
+		_mm_storeu_ps(forceX + i, _mm_add_ps(_mm_loadu_ps(forceX + i), _mm_mul_ps(x, scale)));
+		_mm_storeu_ps(forceY + i, _mm_add_ps(_mm_loadu_ps(forceY + i), _mm_mul_ps(y, scale)));
+		_mm_storeu_ps(forceZ + i, _mm_add_ps(_mm_loadu_ps(forceZ + i), _mm_mul_ps(z, scale)));
+	}
+
+#endif
+
+	// the rest, or all of them without SIMD
+	for (; i < count; ++i) {
+
+		float x = target.x - positionX[i];
+		float y = target.y - positionY[i];
+		float z = target.z - positionZ[i];
+
+		// if not at the target then normalise
+		float scale = maxForce[i] * weight;
+		float distanceSqr = x * x + y * y + z * z;
+		if (distanceSqr > 0)
+			scale /= std::sqrt(distanceSqr);
+
+		forceX[i] += x * scale;
+		forceY[i] += y * scale;
+		forceZ[i] += z * scale;
+	}
+}
+
+// where a target will be after a second at its current velocity
+static glm::vec3 getPredictedPosition(Agent* target) {
+
+	return target->getSharedPosition() + target->getSharedVelocity();
+}
+
 glm::vec3 SeekForce::getForce(Agent* entity) const {
 
 	// get target position
-	auto target = m_target->getPosition();
+	auto target = m_target->getSharedPosition();
 
 	// get my position
 	auto position = entity->getPosition();
@@ -80,10 +266,16 @@ glm::vec3 SeekForce::getForce(Agent* entity) const {
 	return diff * maxForce;
 }
 
+void SeekForce::accumulateForces(AgentStore& store, float weight,
+								 float* forceX, float* forceY, float* forceZ) const {
+	if (m_target != nullptr)
+		accumulateTowards(store, m_target->getSharedPosition(), weight, forceX, forceY, forceZ);
+}
+
 glm::vec3 FleeForce::getForce(Agent* entity) const {
 
 	// get target position
-	auto target = m_target->getPosition();
+	auto target = m_target->getSharedPosition();
 
 	// get my position
 	auto position = entity->getPosition();
@@ -101,20 +293,22 @@ glm::vec3 FleeForce::getForce(Agent* entity) const {
 	return diff * maxForce;
 }
 
+void FleeForce::accumulateForces(AgentStore& store, float weight,
+								 float* forceX, float* forceY, float* forceZ) const {
+	if (m_target != nullptr)
+		accumulateTowards(store, m_target->getSharedPosition(), -weight, forceX, forceY, forceZ);
+}
+
 glm::vec3 PursueForce::getForce(Agent* entity) const {
 
 	// get target position
-	auto target = m_target->getPosition();
-
-	// get target's velocity
-	glm::vec3* velocity = nullptr;
-	m_target->getBlackboard().get("velocity", &velocity);
+	auto target = m_target->getSharedPosition();
 
 	float maxForce = 0;
 	entity->getBlackboard().get("maxForce", maxForce);
 
-	// add velocity to target
-	target += *velocity;
+	// add target's velocity
+	target += m_target->getSharedVelocity();
 
 	// get my position
 	auto position = entity->getPosition();
@@ -129,17 +323,19 @@ glm::vec3 PursueForce::getForce(Agent* entity) const {
 	return diff * maxForce;
 }
 
+void PursueForce::accumulateForces(AgentStore& store, float weight,
+								   float* forceX, float* forceY, float* forceZ) const {
+	if (m_target != nullptr)
+		accumulateTowards(store, getPredictedPosition(m_target), weight, forceX, forceY, forceZ);
+}
+
 glm::vec3 EvadeForce::getForce(Agent* entity) const {
 
 	// get target position
-	auto target = m_target->getPosition();
-
-	// get target's velocity
-	glm::vec3* velocity = nullptr;
-	m_target->getBlackboard().get("velocity", &velocity);
+	auto target = m_target->getSharedPosition();
 
-	// add velocity to target
-	target += *velocity;
+	// add target's velocity
+	target += m_target->getSharedVelocity();
 
 	// get my position
 	auto position = entity->getPosition();
@@ -157,6 +353,39 @@ glm::vec3 EvadeForce::getForce(Agent* entity) const {
 	return diff * maxForce;
 }
 
+void EvadeForce::accumulateForces(AgentStore& store, float weight,
+								  float* forceX, float* forceY, float* forceZ) const {
+	if (m_target != nullptr)
+		accumulateTowards(store, getPredictedPosition(m_target), -weight, forceX, forceY, forceZ);
+}
+
+// the next number from an agent's own xorshift generator, as rand()
+// isn't safe to call from several threads at once
+static unsigned int nextRandom(unsigned int& state) {
+
+	if (state == 0) {
+		// spreads the agents' starting points out
+		static std::atomic<unsigned int> seeds(1);
+		state = seeds.fetch_add(1) * 2654435761u;
+		state = state != 0 ? state : 1;
+	}
+
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+// a random unit vector, as glm::sphericalRand(1.0f)
+static glm::vec3 randomDirection(unsigned int& state) {
+
+	float z = (nextRandom(state) >> 8) * (2.0f / 16777216.0f) - 1;
+	float angle = (nextRandom(state) >> 8) * (6.28318531f / 16777216.0f);
+	float r = std::sqrt(1 - z * z);
+
+	return glm::vec3(r * std::cos(angle), r * std::sin(angle), z);
+}
+
 glm::vec3 WanderForce::getForce(Agent* entity) const {
 
 	WanderData* wd = nullptr;
@@ -168,7 +397,7 @@ glm::vec3 WanderForce::getForce(Agent* entity) const {
 
 	// apply the jitter to our current wander target
 	// generate a random circular direction with a radius of "jitter"
-	wander += glm::normalize(glm::sphericalRand(1.0f) * wd->axisWeights) * wd->jitter;
+	wander += glm::normalize(randomDirection(wd->randomState) * wd->axisWeights) * wd->jitter;
 
 	// bring it back to a radius around the game object
 	wander = glm::normalize(wander) * wd->radius;
@@ -194,6 +423,185 @@ glm::vec3 WanderForce::getForce(Agent* entity) const {
 	return wander * maxForce;
 }
 
+void WanderForce::accumulateForces(AgentStore& store, float weight,
+								   float* forceX, float* forceY, float* forceZ) const {
+
+	unsigned int count = store.getCount();
+
+	float* targetX = store.getComponent(WANDER_TARGET_X);
+	float* targetY = store.getComponent(WANDER_TARGET_Y);
+	float* targetZ = store.getComponent(WANDER_TARGET_Z);
+	const float* offset = store.getComponent(WANDER_OFFSET);
+	const float* radius = store.getComponent(WANDER_RADIUS);
+	const float* jitter = store.getComponent(WANDER_JITTER);
+	const float* axisX = store.getComponent(WANDER_AXIS_X);
+	const float* axisY = store.getComponent(WANDER_AXIS_Y);
+	const float* axisZ = store.getComponent(WANDER_AXIS_Z);
+	const float* velocityX = store.getComponent(VELOCITY_X);
+	const float* velocityY = store.getComponent(VELOCITY_Y);
+	const float* velocityZ = store.getComponent(VELOCITY_Z);
+	const float* maxForce = store.getComponent(MAX_FORCE);
+	unsigned int* randomStates = store.getRandomStates();
+
+	// apply the jitter to the wander targets first, as the random
+	// directions come one at a time, then steer them all together
+	for (unsigned int i = 0; i < count; ++i) {
+
+		if (radius[i] <= 0)
+			continue;
+
+		glm::vec3 direction = glm::normalize(randomDirection(randomStates[i]) * glm::vec3(axisX[i], axisY[i], axisZ[i])) * jitter[i];
+
+		targetX[i] += direction.x;
+		targetY[i] += direction.y;
+		targetZ[i] += direction.z;
+	}
+
+	unsigned int i = 0;
+
+	// lanes that don't wander, or have nothing to normalise, are masked out
+#if defined(STEERING_AVX)
+
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 weights = _mm256_set1_ps(weight);
+
+	auto select = [](__m256 a, __m256 b, __m256 mask) {
+		return _mm256_or_ps(_mm256_and_ps(mask, b), _mm256_andnot_ps(mask, a));
+	};
+	auto lengthSqr = [](__m256 x, __m256 y, __m256 z) {
+		return _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)), _mm256_mul_ps(z, z));
+	};
+
+	for (; i + 8 <= count; i += 8) {
+
+		__m256 wandering = _mm256_cmp_ps(_mm256_loadu_ps(radius + i), zero, _CMP_GT_OQ);
+
+		// bring the target back to a radius around the agent
+		__m256 x = _mm256_loadu_ps(targetX + i);
+		__m256 y = _mm256_loadu_ps(targetY + i);
+		__m256 z = _mm256_loadu_ps(targetZ + i);
+		__m256 scale = _mm256_div_ps(_mm256_loadu_ps(radius + i), _mm256_sqrt_ps(lengthSqr(x, y, z)));
+		x = _mm256_mul_ps(x, scale);
+		y = _mm256_mul_ps(y, scale);
+		z = _mm256_mul_ps(z, scale);
+
+		_mm256_storeu_ps(targetX + i, select(_mm256_loadu_ps(targetX + i), x, wandering));
+		_mm256_storeu_ps(targetY + i, select(_mm256_loadu_ps(targetY + i), y, wandering));
+		_mm256_storeu_ps(targetZ + i, select(_mm256_loadu_ps(targetZ + i), z, wandering));
+
+		// offset it along the velocity
+		__m256 vx = _mm256_loadu_ps(velocityX + i);
+		__m256 vy = _mm256_loadu_ps(velocityY + i);
+		__m256 vz = _mm256_loadu_ps(velocityZ + i);
+		__m256 speedSqr = lengthSqr(vx, vy, vz);
+		scale = select(zero, _mm256_div_ps(_mm256_loadu_ps(offset + i), _mm256_sqrt_ps(speedSqr)),
+					   _mm256_cmp_ps(speedSqr, zero, _CMP_GT_OQ));
+		x = _mm256_add_ps(x, _mm256_mul_ps(vx, scale));
+		y = _mm256_add_ps(y, _mm256_mul_ps(vy, scale));
+		z = _mm256_add_ps(z, _mm256_mul_ps(vz, scale));
+
+		// normalise the new direction
+		__m256 distanceSqr = lengthSqr(x, y, z);
+		scale = _mm256_mul_ps(_mm256_loadu_ps(maxForce + i), weights);
+		scale = select(scale, _mm256_div_ps(scale, _mm256_sqrt_ps(distanceSqr)),
+					   _mm256_cmp_ps(distanceSqr, zero, _CMP_GT_OQ));
+		x = _mm256_and_ps(_mm256_mul_ps(x, scale), wandering);
+		y = _mm256_and_ps(_mm256_mul_ps(y, scale), wandering);
+		z = _mm256_and_ps(_mm256_mul_ps(z, scale), wandering);
+
+		_mm256_storeu_ps(forceX + i, _mm256_add_ps(_mm256_loadu_ps(forceX + i), x));
+		_mm256_storeu_ps(forceY + i, _mm256_add_ps(_mm256_loadu_ps(forceY + i), y));
+		_mm256_storeu_ps(forceZ + i, _mm256_add_ps(_mm256_loadu_ps(forceZ + i), z));
+	}
+
+#elif defined(STEERING_SSE)
+
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 weights = _mm_set1_ps(weight);
+
+	auto select = [](__m128 a, __m128 b, __m128 mask) {
+		return _mm_or_ps(_mm_and_ps(mask, b), _mm_andnot_ps(mask, a));
+	};
+	auto lengthSqr = [](__m128 x, __m128 y, __m128 z) {
+		return _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+	};
+
+	for (; i + 4 <= count; i += 4) {
+
+		__m128 wandering = _mm_cmpgt_ps(_mm_loadu_ps(radius + i), zero);
+
+		// bring the target back to a radius around the agent
+		__m128 x = _mm_loadu_ps(targetX + i);
+		__m128 y = _mm_loadu_ps(targetY + i);
+		__m128 z = _mm_loadu_ps(targetZ + i);
+		__m128 scale = _mm_div_ps(_mm_loadu_ps(radius + i), _mm_sqrt_ps(lengthSqr(x, y, z)));
+		x = _mm_mul_ps(x, scale);
+		y = _mm_mul_ps(y, scale);
+		z = _mm_mul_ps(z, scale);
+
+		_mm_storeu_ps(targetX + i, select(_mm_loadu_ps(targetX + i), x, wandering));
+		_mm_storeu_ps(targetY + i, select(_mm_loadu_ps(targetY + i), y, wandering));
+		_mm_storeu_ps(targetZ + i, select(_mm_loadu_ps(targetZ + i), z, wandering));
+
+		// offset it along the velocity
+		__m128 vx = _mm_loadu_ps(velocityX + i);
+		__m128 vy = _mm_loadu_ps(velocityY + i);
+		__m128 vz = _mm_loadu_ps(velocityZ + i);
+		__m128 speedSqr = lengthSqr(vx, vy, vz);
+		scale = select(zero, _mm_div_ps(_mm_loadu_ps(offset + i), _mm_sqrt_ps(speedSqr)),
+					   _mm_cmpgt_ps(speedSqr, zero));
+		x = _mm_add_ps(x, _mm_mul_ps(vx, scale));
+		y = _mm_add_ps(y, _mm_mul_ps(vy, scale));
+		z = _mm_add_ps(z, _mm_mul_ps(vz, scale));
+
+		// normalise the new direction
+		__m128 distanceSqr = lengthSqr(x, y, z);
+		scale = _mm_mul_ps(_mm_loadu_ps(maxForce + i), weights);
+		scale = select(scale, _mm_div_ps(scale, _mm_sqrt_ps(distanceSqr)),
+					   _mm_cmpgt_ps(distanceSqr, zero));
+		x = _mm_and_ps(_mm_mul_ps(x, scale), wandering);
+		y = _mm_and_ps(_mm_mul_ps(y, scale), wandering);
+		z = _mm_and_ps(_mm_mul_ps(z, scale), wandering);
+
+		_mm_storeu_ps(forceX + i, _mm_add_ps(_mm_loadu_ps(forceX + i), x));
+		_mm_storeu_ps(forceY + i, _mm_add_ps(_mm_loadu_ps(forceY + i), y));
+		_mm_storeu_ps(forceZ + i, _mm_add_ps(_mm_loadu_ps(forceZ + i), z));
+	}
+
+#endif
+
+	// the rest, or all of them without SIMD
+	for (; i < count; ++i) {
+
+		if (radius[i] <= 0)
+			continue;
+
+		// bring the target back to a radius around the agent
+		glm::vec3 wander(targetX[i], targetY[i], targetZ[i]);
+		wander *= radius[i] / std::sqrt(glm::dot(wander, wander));
+
+		targetX[i] = wander.x;
+		targetY[i] = wander.y;
+		targetZ[i] = wander.z;
+
+		// offset it along the velocity
+		glm::vec3 velocity(velocityX[i], velocityY[i], velocityZ[i]);
+		float speedSqr = glm::dot(velocity, velocity);
+		if (speedSqr > 0)
+			wander += velocity * (offset[i] / std::sqrt(speedSqr));
+
+		// normalise the new direction
+		float scale = maxForce[i] * weight;
+		float distanceSqr = glm::dot(wander, wander);
+		if (distanceSqr > 0)
+			scale /= std::sqrt(distanceSqr);
+
+		forceX[i] += wander.x * scale;
+		forceY[i] += wander.y * scale;
+		forceZ[i] += wander.z * scale;
+	}
+}
+
 glm::vec3 ObstacleAvoidanceForce::getForce(ai::Agent* entity) const {
 
 	glm::vec3 force(0);
@@ -302,25 +710,41 @@ glm::vec3 SeparationForce::getForce(Agent* entity) const {
 	glm::vec3 force(0);
 	int neighbours = 0;
 
-	for (auto& e : *m_entities) {
+	if (m_grid != nullptr) {
 
-		if (&e == entity) continue;
+		unsigned int self = m_grid->getIndex(entity);
 
-		auto target = e.getPosition();
+		m_grid->query(position, m_radius, [&](const SpatialGrid::Entry& e, float distanceSqr) {
 
-		// compare the two and get the distance between them
-		auto diff = position - target;
-		float distanceSqr = glm::dot(diff, diff);
+			// push away from entity!
+			if (e.index != self &&
+				distanceSqr > 0) {
+				neighbours++;
+				force += glm::normalize(position - e.position);
+			}
+		});
+	}
+	else {
+		for (auto& e : *m_entities) {
 
-		// is it within radius?
-		if (distanceSqr > 0 &&
-			distanceSqr < (m_radius * m_radius)) {
+			if (&e == entity) continue;
 
-			// push away from entity!
-			diff = glm::normalize(diff);
+			auto target = e.getSharedPosition();
 
-			neighbours++;
-			force += diff;
+			// compare the two and get the distance between them
+			auto diff = position - target;
+			float distanceSqr = glm::dot(diff, diff);
+
+			// is it within radius?
+			if (distanceSqr > 0 &&
+				distanceSqr < (m_radius * m_radius)) {
+
+				// push away from entity!
+				diff = glm::normalize(diff);
+
+				neighbours++;
+				force += diff;
+			}
 		}
 	}
 
@@ -333,6 +757,14 @@ glm::vec3 SeparationForce::getForce(Agent* entity) const {
 	return force * maxForce;
 }
 
+void SeparationForce::accumulateForces(AgentStore& store, float weight,
+									    float* forceX, float* forceY, float* forceZ) const {
+
+	assert(m_grid == nullptr && "SeparationForce can't use a grid with an AgentStore");
+
+	SteeringForce::accumulateForces(store, weight, forceX, forceY, forceZ);
+}
+
 glm::vec3 CohesionForce::getForce(Agent* entity) const {
 
 	// get my position
@@ -341,21 +773,35 @@ glm::vec3 CohesionForce::getForce(Agent* entity) const {
 	glm::vec3 force(0);
 	int neighbours = 0;
 
-	for (auto& e : *m_entities) {
+	if (m_grid != nullptr) {
 
-		if (&e == entity) continue;
+		unsigned int self = m_grid->getIndex(entity);
 
-		auto target = e.getPosition();
+		m_grid->query(position, m_radius, [&](const SpatialGrid::Entry& e, float distanceSqr) {
+			if (e.index != self &&
+				distanceSqr > 0) {
+				neighbours++;
+				force += e.position;
+			}
+		});
+	}
+	else {
+		for (auto& e : *m_entities) {
 
-		// compare the two and get the distance between them
-		auto diff = position - target;
-		float distanceSqr = glm::dot(diff, diff);
+			if (&e == entity) continue;
 
-		// is it within radius?
-		if (distanceSqr > 0 &&
-			distanceSqr < (m_radius * m_radius)) {
-			neighbours++;
-			force += target;
+			auto target = e.getSharedPosition();
+
+			// compare the two and get the distance between them
+			auto diff = position - target;
+			float distanceSqr = glm::dot(diff, diff);
+
+			// is it within radius?
+			if (distanceSqr > 0 &&
+				distanceSqr < (m_radius * m_radius)) {
+				neighbours++;
+				force += target;
+			}
 		}
 	}
 
@@ -374,6 +820,14 @@ glm::vec3 CohesionForce::getForce(Agent* entity) const {
 	return force * maxForce;
 }
 
+void CohesionForce::accumulateForces(AgentStore& store, float weight,
+									  float* forceX, float* forceY, float* forceZ) const {
+
+	assert(m_grid == nullptr && "CohesionForce can't use a grid with an AgentStore");
+
+	SteeringForce::accumulateForces(store, weight, forceX, forceY, forceZ);
+}
+
 glm::vec3 AlignmentForce::getForce(Agent* entity) const {
 
 	// get my position
@@ -382,26 +836,40 @@ glm::vec3 AlignmentForce::getForce(Agent* entity) const {
 	glm::vec3 force(0);
 	int neighbours = 0;
 
-	for (auto& e : *m_entities) {
+	if (m_grid != nullptr) {
+
+		unsigned int self = m_grid->getIndex(entity);
+
+		m_grid->query(position, m_radius, [&](const SpatialGrid::Entry& e, float distanceSqr) {
+			if (e.index != self &&
+				distanceSqr > 0 &&
+				glm::dot(e.velocity, e.velocity) > 0) {
+				neighbours++;
+				force += e.velocity;
+			}
+		});
+	}
+	else {
+		for (auto& e : *m_entities) {
 
-		if (&e == entity) continue;
+			if (&e == entity) continue;
 
-		auto target = e.getPosition();
+			auto target = e.getSharedPosition();
 
-		// compare the two and get the distance between them
-		auto diff = position - target;
-		float distanceSqr = glm::dot(diff, diff);
+			// compare the two and get the distance between them
+			auto diff = position - target;
+			float distanceSqr = glm::dot(diff, diff);
 
-		// is it within radius?
-		if (distanceSqr > 0 &&
-			distanceSqr < (m_radius * m_radius)) {
+			// is it within radius?
+			if (distanceSqr > 0 &&
+				distanceSqr < (m_radius * m_radius)) {
 
-			glm::vec3* v = nullptr;
-			e.getBlackboard().get("velocity", &v);
+				auto v = e.getSharedVelocity();
 
-			if (glm::dot(*v, *v) > 0) {
-				neighbours++;
-				force += *v;
+				if (glm::dot(v, v) > 0) {
+					neighbours++;
+					force += v;
+				}
 			}
 		}
 	}
@@ -424,13 +892,178 @@ glm::vec3 AlignmentForce::getForce(Agent* entity) const {
 	return force * maxForce;
 }
 
-glm::vec3 FlowForce::getForce(Agent* entity) const {
+void AlignmentForce::accumulateForces(AgentStore& store, float weight,
+									   float* forceX, float* forceY, float* forceZ) const {
 
-	if (m_flowField == nullptr)
-		return {};
+	assert(m_grid == nullptr && "AlignmentForce can't use a grid with an AgentStore");
 
+	SteeringForce::accumulateForces(store, weight, forceX, forceY, forceZ);
+}
+
+glm::vec3 FlockingForce::getForce(Agent* entity) const {
+
+	// get my position
 	auto position = entity->getPosition();
 
+	glm::vec3 separation(0), cohesion(0), alignment(0);
+	int neighbours = 0, moving = 0;
+
+	// neighbours with no velocity don't count towards alignment
+	auto accumulate = [&](const glm::vec3& target, const glm::vec3& velocity, float distanceSqr) {
+		neighbours++;
+		separation += (position - target) / std::sqrt(distanceSqr);
+		cohesion += target;
+
+		if (glm::dot(velocity, velocity) > 0) {
+			moving++;
+			alignment += velocity;
+		}
+	};
+
+	if (m_grid != nullptr) {
+
+		unsigned int self = m_grid->getIndex(entity);
+
+		m_grid->query(position, m_radius, [&](const SpatialGrid::Entry& e, float distanceSqr) {
+			if (e.index != self &&
+				distanceSqr > 0)
+				accumulate(e.position, e.velocity, distanceSqr);
+		});
+	}
+	else {
+		for (auto& e : *m_entities) {
+
+			if (&e == entity) continue;
+
+			auto target = e.getSharedPosition();
+
+			// compare the two and get the distance between them
+			auto diff = position - target;
+			float distanceSqr = glm::dot(diff, diff);
+
+			// is it within radius?
+			if (distanceSqr > 0 &&
+				distanceSqr < (m_radius * m_radius)) {
+
+				accumulate(target, e.getSharedVelocity(), distanceSqr);
+			}
+		}
+	}
+
+	glm::vec3 force(0);
+
+	if (neighbours > 0) {
+
+		separation /= (float)neighbours;
+
+		cohesion = cohesion / (float)neighbours - position;
+		if (glm::dot(cohesion, cohesion) > 0)
+			cohesion = glm::normalize(cohesion);
+
+		force = separation * m_separationWeight + cohesion * m_cohesionWeight;
+	}
+
+	if (moving > 0) {
+
+		glm::vec3* v = nullptr;
+		entity->getBlackboard().get("velocity", &v);
+
+		alignment = alignment / (float)moving - *v;
+		if (glm::dot(alignment, alignment) > 0)
+			alignment = glm::normalize(alignment);
+
+		force += alignment * m_alignmentWeight;
+	}
+
+	float maxForce = 0;
+	entity->getBlackboard().get("maxForce", maxForce);
+
+	return force * maxForce;
+}
+
+void FlockingForce::accumulateForces(AgentStore& store, float weight,
+									 float* forceX, float* forceY, float* forceZ) const {
+
+	m_storeGrid.setCellSize(m_radius);
+	m_storeGrid.build(store);
+
+	const float* positionX = store.getComponent(POSITION_X);
+	const float* positionY = store.getComponent(POSITION_Y);
+	const float* positionZ = store.getComponent(POSITION_Z);
+	const float* velocityX = store.getComponent(VELOCITY_X);
+	const float* velocityY = store.getComponent(VELOCITY_Y);
+	const float* velocityZ = store.getComponent(VELOCITY_Z);
+	const float* maxForce = store.getComponent(MAX_FORCE);
+
+	unsigned int count = store.getCount();
+
+	for (unsigned int i = 0; i < count; ++i) {
+
+		glm::vec3 position(positionX[i], positionY[i], positionZ[i]);
+
+		glm::vec3 separation(0), cohesion(0), alignment(0);
+		int neighbours = 0, moving = 0;
+
+		m_storeGrid.query(position, m_radius, [&](const SpatialGrid::Entry& e, float distanceSqr) {
+
+			if (e.index == i ||
+				distanceSqr <= 0)
+				return;
+
+			neighbours++;
+			separation += (position - e.position) / std::sqrt(distanceSqr);
+			cohesion += e.position;
+
+			// neighbours with no velocity don't count towards alignment
+			if (glm::dot(e.velocity, e.velocity) > 0) {
+				moving++;
+				alignment += e.velocity;
+			}
+		});
+
+		glm::vec3 force(0);
+
+		if (neighbours > 0) {
+
+			separation /= (float)neighbours;
+
+			cohesion = cohesion / (float)neighbours - position;
+			if (glm::dot(cohesion, cohesion) > 0)
+				cohesion = glm::normalize(cohesion);
+
+			force = separation * m_separationWeight + cohesion * m_cohesionWeight;
+		}
+
+		if (moving > 0) {
+
+			alignment = alignment / (float)moving - glm::vec3(velocityX[i], velocityY[i], velocityZ[i]);
+			if (glm::dot(alignment, alignment) > 0)
+				alignment = glm::normalize(alignment);
+
+			force += alignment * m_alignmentWeight;
+		}
+
+		force *= maxForce[i] * weight;
+
+		forceX[i] += force.x;
+		forceY[i] += force.y;
+		forceZ[i] += force.z;
+	}
+}
+
+glm::vec3 FlowForce::getFlow(const glm::vec3& position) const {
+
+	if (m_cache != nullptr) {
+
+		int x = (int)std::floor(position.x / m_cellSize);
+		int y = (int)std::floor(position.y / m_cellSize);
+
+		return m_cache->getFlow(m_handle, x, y);
+	}
+
+	if (m_flowField == nullptr)
+		return {};
+
 	glm::ivec3 cell = position / m_cellSize;
 
 	// off-grid?
@@ -440,10 +1073,63 @@ glm::vec3 FlowForce::getForce(Agent* entity) const {
 
 	int index = cell.z * (m_cols * m_rows) + cell.y * m_cols + cell.x;
 
+	return m_flowField[index];
+}
+
+glm::vec3 FlowForce::getForce(Agent* entity) const {
+
+	if (m_cache == nullptr &&
+		m_flowField == nullptr)
+		return {};
+
+	float maxForce = 0;
+	entity->getBlackboard().get("maxForce", maxForce);
+
+	return getFlow(entity->getPosition()) * maxForce;
+}
+
+void FlowForce::accumulateForces(AgentStore& store, float weight,
+								 float* forceX, float* forceY, float* forceZ) const {
+
+	if (m_cache == nullptr &&
+		m_flowField == nullptr)
+		return;
+
+	const float* positionX = store.getComponent(POSITION_X);
+	const float* positionY = store.getComponent(POSITION_Y);
+	const float* positionZ = store.getComponent(POSITION_Z);
+	const float* maxForce = store.getComponent(MAX_FORCE);
+
+	unsigned int count = store.getCount();
+
+	for (unsigned int i = 0; i < count; ++i) {
+
+		glm::vec3 force = getFlow(glm::vec3(positionX[i], positionY[i], positionZ[i])) * (maxForce[i] * weight);
+
+		forceX[i] += force.x;
+		forceY[i] += force.y;
+		forceZ[i] += force.z;
+	}
+}
+
+glm::vec3 SectorFlowForce::getForce(Agent* entity) const {
+
+	if (m_flowField == nullptr ||
+		m_flowField->isPassable(m_goalX, m_goalY) == false)
+		return {};
+
+	auto position = entity->getPosition();
+
+	int x = (int)std::floor(position.x / m_cellSize);
+	int y = (int)std::floor(position.y / m_cellSize);
+
+	if (m_flowField->isInside(x, y) == false)
+		return {};
+
 	float maxForce = 0;
 	entity->getBlackboard().get("maxForce", maxForce);
 
-	return m_flowField[index] * maxForce;
+	return m_flowField->getFlow(m_goalX, m_goalY, x, y) * maxForce;
 }
 
 } // namespace ai
\ No newline at end of file
@@ -1,16 +1,36 @@
 #pragma once
 
 #include "State.h"
+#include "SpatialGrid.h"
 #include <glm/glm.hpp>
 
+// the batch versions of seek, flee, pursue, evade and wander steer 8
+// agents at a time with AVX, 4 with SSE2, or one at a time where neither
+// is available. Define STEERING_NO_SIMD to always use the plain version
+#if !defined(STEERING_NO_SIMD)
+#if defined(__AVX__)
+#define STEERING_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define STEERING_SSE
+#endif
+#endif
+
 namespace ai {
 
+class SectorFlowField;
+class FlowFieldCache;
+class AgentStore;
+
 struct WanderData {
 	float offset;
 	float radius;
 	float jitter;
 	glm::vec3 target;
 	glm::vec3 axisWeights = { 1,1,1 };
+
+	// the agent's own random numbers for the jitter, seeded on first
+	// use, so that agents can wander on separate threads
+	unsigned int randomState = 0;
 };
 
 // abstract class
@@ -22,6 +42,18 @@ public:
 
 	// pure virtual function
 	virtual glm::vec3 getForce(Agent* entity) const = 0;
+
+	// adds the force on every agent in a store, scaled by weight, to the
+	// forces for a SteeringSystem. Forces without a batch version fall back
+	// to getForce() on one stand-in Agent, which is much slower. The
+	// stand-in has only the agent's position and the blackboard entries
+	// "velocity" (a glm::vec3*), "maxForce" and "maxVelocity", so forces
+	// that need anything else, such as "wanderData", need a batch version.
+	// Any other agents a force reads, such as the neighbours of separation,
+	// cohesion and alignment, are still its own Agents, and as the stand-in
+	// isn't one of them it can't be found in a SpatialGrid
+	virtual void accumulateForces(AgentStore& store, float weight,
+								  float* forceX, float* forceY, float* forceZ) const;
 };
 
 // weighted steering force
@@ -82,6 +114,40 @@ protected:
 	std::vector<WeightedForce>	m_forces;
 };
 
+// steers every agent in an AgentStore, applying each force to all of the
+// agents before moving on to the next rather than agent by agent
+class SteeringSystem {
+public:
+
+	SteeringSystem(AgentStore* store = nullptr) : m_store(store) {}
+	~SteeringSystem() {}
+
+	void setStore(AgentStore* store) { m_store = store; }
+	AgentStore* getStore() const { return m_store; }
+
+	void addForce(SteeringForce* force, float weight = 1.0f) {
+		WeightedForce wf = { force, weight };
+		m_forces.push_back(wf);
+	}
+
+	void setWeightForForce(SteeringForce* force, float weight) {
+		for (auto& wf : m_forces) {
+			if (wf.force == force)
+				wf.weight = weight;
+		}
+	}
+
+	// accumulates the forces, then caps the agents' velocities and moves them
+	void update(float deltaTime);
+
+protected:
+
+	AgentStore*					m_store;
+	std::vector<WeightedForce>	m_forces;
+
+	std::vector<float>	m_forceX, m_forceY, m_forceZ;
+};
+
 class SeekForce : public SteeringForce {
 public:
 
@@ -91,6 +157,8 @@ public:
 	void setTarget(Agent* target) { m_target = target; }
 
 	virtual glm::vec3 getForce(Agent* entity) const;
+	virtual void accumulateForces(AgentStore& store, float weight,
+								  float* forceX, float* forceY, float* forceZ) const;
 
 protected:
 
@@ -106,6 +174,8 @@ public:
 	void setTarget(Agent* target) { m_target = target; }
 
 	virtual glm::vec3 getForce(Agent* entity) const;
+	virtual void accumulateForces(AgentStore& store, float weight,
+								  float* forceX, float* forceY, float* forceZ) const;
 
 protected:
 
@@ -121,6 +191,8 @@ public:
 	void setTarget(Agent* target) { m_target = target; }
 
 	virtual glm::vec3 getForce(Agent* entity) const;
+	virtual void accumulateForces(AgentStore& store, float weight,
+								  float* forceX, float* forceY, float* forceZ) const;
 
 protected:
 
@@ -136,6 +208,8 @@ public:
 	void setTarget(Agent* target) { m_target = target; }
 
 	virtual glm::vec3 getForce(Agent* entity) const;
+	virtual void accumulateForces(AgentStore& store, float weight,
+								  float* forceX, float* forceY, float* forceZ) const;
 
 protected:
 
@@ -149,6 +223,10 @@ public:
 	virtual ~WanderForce() {}
 
 	virtual glm::vec3 getForce(Agent* entity) const;
+
+	// uses the wander components of the store in place of WanderData
+	virtual void accumulateForces(AgentStore& store, float weight,
+								  float* forceX, float* forceY, float* forceZ) const;
 };
 
 // obstacles
@@ -212,58 +290,131 @@ public:
 class SeparationForce : public SteeringForce {
 public:
 
-	SeparationForce() {}
+	SeparationForce() : m_grid(nullptr) {}
 	virtual ~SeparationForce() {}
 
 	void setEntities(std::vector<Agent>* entities) { m_entities = entities; }
 	void setRadius(float radius) { m_radius = radius; }
 
+	// finds neighbours with a grid built from the entities this update
+	// rather than checking every entity, null to check them all
+	void setGrid(const SpatialGrid* grid) { m_grid = grid; }
+
 	virtual glm::vec3 getForce(Agent* entity) const;
 
+	// uses the stand-in of SteeringForce::accumulateForces(), so can't
+	// be used with a grid, which would never find the stand-in to skip it
+	virtual void accumulateForces(AgentStore& store, float weight,
+								  float* forceX, float* forceY, float* forceZ) const;
+
 protected:
 
 	std::vector<Agent>*	m_entities;
 	float					m_radius;
+	const SpatialGrid*		m_grid;
 };
 
 class CohesionForce : public SteeringForce {
 public:
 
-	CohesionForce() {}
+	CohesionForce() : m_grid(nullptr) {}
 	virtual ~CohesionForce() {}
 
 	void setEntities(std::vector<Agent>* entities) { m_entities = entities; }
 	void setRadius(float radius) { m_radius = radius; }
 
+	// finds neighbours with a grid built from the entities this update
+	// rather than checking every entity, null to check them all
+	void setGrid(const SpatialGrid* grid) { m_grid = grid; }
+
 	virtual glm::vec3 getForce(Agent* entity) const;
 
+	// uses the stand-in of SteeringForce::accumulateForces(), so can't
+	// be used with a grid, which would never find the stand-in to skip it
+	virtual void accumulateForces(AgentStore& store, float weight,
+								  float* forceX, float* forceY, float* forceZ) const;
+
 protected:
 
 	std::vector<Agent>*	m_entities;
 	float					m_radius;
+	const SpatialGrid*		m_grid;
 };
 
 class AlignmentForce : public SteeringForce {
 public:
 
-	AlignmentForce() {}
+	AlignmentForce() : m_grid(nullptr) {}
 	virtual ~AlignmentForce() {}
 
 	void setEntities(std::vector<Agent>* entities) { m_entities = entities; }
 	void setRadius(float radius) { m_radius = radius; }
 
+	// finds neighbours with a grid built from the entities this update
+	// rather than checking every entity, null to check them all
+	void setGrid(const SpatialGrid* grid) { m_grid = grid; }
+
 	virtual glm::vec3 getForce(Agent* entity) const;
 
+	// uses the stand-in of SteeringForce::accumulateForces(), so can't
+	// be used with a grid, which would never find the stand-in to skip it
+	virtual void accumulateForces(AgentStore& store, float weight,
+								  float* forceX, float* forceY, float* forceZ) const;
+
 protected:
 
 	std::vector<Agent>*	m_entities;
 	float						m_radius;
+	const SpatialGrid*			m_grid;
+};
+
+// separation, cohesion and alignment in one pass over the neighbours,
+// the same as adding the three forces with these weights
+class FlockingForce : public SteeringForce {
+public:
+
+	FlockingForce()
+		: m_entities(nullptr), m_radius(100), m_grid(nullptr),
+		m_separationWeight(1), m_cohesionWeight(1), m_alignmentWeight(1) {}
+	virtual ~FlockingForce() {}
+
+	void setEntities(std::vector<Agent>* entities) { m_entities = entities; }
+	void setRadius(float radius) { m_radius = radius; }
+
+	// finds neighbours with a grid built from the entities this update
+	// rather than checking every entity, null to check them all
+	void setGrid(const SpatialGrid* grid) { m_grid = grid; }
+
+	void setWeights(float separation, float cohesion, float alignment) {
+		m_separationWeight = separation;
+		m_cohesionWeight = cohesion;
+		m_alignmentWeight = alignment;
+	}
+
+	virtual glm::vec3 getForce(Agent* entity) const;
+
+	// finds neighbours among the agents in the store rather than the
+	// entities, with a grid of its own rebuilt from the store each call
+	virtual void accumulateForces(AgentStore& store, float weight,
+								  float* forceX, float* forceY, float* forceZ) const;
+
+protected:
+
+	std::vector<Agent>*	m_entities;
+	float					m_radius;
+	const SpatialGrid*		m_grid;
+
+	float	m_separationWeight;
+	float	m_cohesionWeight;
+	float	m_alignmentWeight;
+
+	mutable SpatialGrid	m_storeGrid;
 };
 
 class FlowForce : public SteeringForce {
 public:
 
-	FlowForce() : m_flowField(nullptr) {}
+	FlowForce() : m_flowField(nullptr), m_cache(nullptr), m_handle(0) {}
 	virtual ~FlowForce() {}
 
 	void setField(glm::vec3* flowField, int rows, int cols, int depth, float cellSize) {
@@ -272,15 +423,61 @@ public:
 		m_cols = cols;
 		m_depth = depth;
 		m_cellSize = cellSize;
+		m_cache = nullptr;
+	}
+
+	// follows a field held in a cache, looked up by its handle each time
+	// so that the cache can integrate it again when costs change. The
+	// force doesn't count a reference, the caller must hold the handle
+	void setField(FlowFieldCache* cache, unsigned int handle, float cellSize) {
+		m_flowField = nullptr;
+		m_cache = cache;
+		m_handle = handle;
+		m_cellSize = cellSize;
 	}
 
 	virtual glm::vec3 getForce(Agent* entity) const;
+	virtual void accumulateForces(AgentStore& store, float weight,
+								  float* forceX, float* forceY, float* forceZ) const;
 
 protected:
 
+	// the direction of the field at a position, 0 off the field
+	glm::vec3 getFlow(const glm::vec3& position) const;
+
 	glm::vec3* m_flowField;
 	int m_rows, m_cols, m_depth;
 	float m_cellSize;
+
+	FlowFieldCache* m_cache;
+	unsigned int m_handle;
+};
+
+// follows a sectored flow field towards a goal cell, making
+// sectors of the field as agents reach them
+class SectorFlowForce : public SteeringForce {
+public:
+
+	SectorFlowForce() : m_flowField(nullptr), m_goalX(-1), m_goalY(-1), m_cellSize(1) {}
+	virtual ~SectorFlowForce() {}
+
+	void setField(SectorFlowField* flowField, float cellSize) {
+		m_flowField = flowField;
+		m_cellSize = cellSize;
+	}
+
+	void setGoal(int x, int y) {
+		m_goalX = x;
+		m_goalY = y;
+	}
+
+	virtual glm::vec3 getForce(Agent* entity) const;
+
+protected:
+
+	SectorFlowField* m_flowField;
+	int m_goalX, m_goalY;
+	float m_cellSize;
 };
 
 } // namespace ai
\ No newline at end of file
@@ -0,0 +1,136 @@
+#include "TimeSlicedAStar.h"
+
+namespace graph {
+
+TimeSlicedAStar::TimeSlicedAStar()
+	: m_start(nullptr),
+	m_end(nullptr),
+	m_best(INVALID_INDEX),
+	m_excludeFlags(0),
+	m_version(0),
+	m_status(IDLE) {
+}
+
+void TimeSlicedAStar::begin(Node* start, Node* end, Search::HeuristicCheck heuristic, unsigned int excludeFlags) {
+
+	m_heuristic = heuristic;
+	m_start = start;
+	m_end = end;
+	m_excludeFlags = excludeFlags;
+
+	restart();
+}
+
+void TimeSlicedAStar::restart() {
+
+	m_best = INVALID_INDEX;
+
+	// as with aStar there is no path from a node to itself
+	if (m_start == nullptr ||
+		m_end == nullptr ||
+		m_start == m_end) {
+		m_status = NOT_FOUND;
+		return;
+	}
+
+	m_version = m_start->getGraphVersion().get();
+
+	m_context.begin(Node::getIDCount());
+
+	bool reached = false;
+	auto& record = m_context.visit(m_start->getID(), m_start, reached);
+	record.gScore = 0;
+	record.hScore = m_heuristic(m_start, m_end);
+	record.fScore = record.hScore;
+
+	m_context.push(m_start->getID());
+
+	m_status = SEARCHING;
+}
+
+void TimeSlicedAStar::cancel() {
+	m_start = nullptr;
+	m_end = nullptr;
+	m_best = INVALID_INDEX;
+	m_status = IDLE;
+}
+
+TimeSlicedAStar::eStatus TimeSlicedAStar::step(unsigned int maxExpansions) {
+
+	if (m_status != SEARCHING)
+		return m_status;
+
+	// only changes to the graph being searched matter
+	if (m_version != m_start->getGraphVersion().get())
+		restart();
+
+	Node* end = m_end;
+	auto& heuristic = m_heuristic;
+
+	NodeGraphEdges<Search::ExcludeFlags> edges = { Search::ExcludeFlags{ m_excludeFlags } };
+	auto estimate = [end, &heuristic](unsigned int, Node* n) { return heuristic(n, end); };
+
+	for (unsigned int i = 0; i < maxExpansions; ++i) {
+
+		if (m_context.m_open.empty()) {
+			m_status = NOT_FOUND;
+			break;
+		}
+
+		unsigned int current = m_context.m_open.front();
+
+		if (m_context.m_records[current].node == m_end) {
+			m_best = current;
+			m_status = FOUND;
+			break;
+		}
+
+		Search::expand(m_context, edges, estimate);
+
+		// closest to the goal, or cheapest to reach if as close
+		auto& record = m_context.m_records[current];
+		if (m_best == INVALID_INDEX ||
+			record.hScore < m_context.m_records[m_best].hScore ||
+			(record.hScore == m_context.m_records[m_best].hScore &&
+			 record.gScore < m_context.m_records[m_best].gScore))
+			m_best = current;
+	}
+
+	return m_status;
+}
+
+bool TimeSlicedAStar::getPath(Path& path) const {
+
+	path.clear();
+
+	if (m_status != FOUND)
+		return false;
+
+	return Search::buildPath(m_context, m_end, path);
+}
+
+bool TimeSlicedAStar::getPath(std::list<Node*>& path) const {
+
+	path.clear();
+
+	if (m_status != FOUND)
+		return false;
+
+	return Search::buildPath(m_context, m_end, path);
+}
+
+bool TimeSlicedAStar::getBestPath(Path& path) const {
+
+	path.clear();
+
+	if (m_status == FOUND)
+		return getPath(path);
+
+	if (m_status != SEARCHING ||
+		m_best == INVALID_INDEX)
+		return false;
+
+	return Search::buildPath(m_context, m_context.m_records[m_best].node, path);
+}
+
+} // namespace graph
\ No newline at end of file
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Pathfinding.h"
+
+namespace graph {
+
+// an A* search that can be spread over several frames, so that one long
+// search can't stall a frame. begin() sets up the search and each step()
+// expands at most a budget of nodes, keeping the open and closed lists
+// in between. While it runs getBestPath() gives the path to the node
+// thought closest to the goal so far, so that an agent can set off
+// before the whole path is known; it may turn out to be a dead end.
+// If the version of the graph being searched changes meanwhile the
+// search starts over, as nodes it had reached may have been deleted,
+// while changes to other graphs are ignored. If the start or goal is
+// deleted, cancel() or begin() a new search
+class TimeSlicedAStar {
+public:
+
+	enum eStatus {
+		IDLE,		// never begun or cancelled
+		SEARCHING,	// needs more steps
+		FOUND,
+		NOT_FOUND,
+	};
+
+	TimeSlicedAStar();
+	~TimeSlicedAStar() {}
+
+	// starts a new search, following only edges without any of the excluded flags
+	void begin(Node* start, Node* end, Search::HeuristicCheck heuristic, unsigned int excludeFlags = 0);
+
+	// expands up to maxExpansions nodes, returning the new status
+	eStatus step(unsigned int maxExpansions);
+
+	void cancel();
+
+	eStatus getStatus() const { return m_status; }
+	bool isSearching() const { return m_status == SEARCHING; }
+
+	Node* getStart() const { return m_start; }
+	Node* getEnd() const { return m_end; }
+
+	// the path from the start to the goal, false until FOUND
+	bool getPath(Path& path) const;
+	bool getPath(std::list<Node*>& path) const;
+
+	// the path to the expanded node with the lowest heuristic, or the
+	// whole path once FOUND. False if nothing past the start is expanded
+	bool getBestPath(Path& path) const;
+
+	// nodes expanded over every step since the search began
+	unsigned int getExpandedCount() const { return m_context.getExpandedCount(); }
+
+protected:
+
+	// begins again with the same start, goal and heuristic
+	void restart();
+
+	SearchContext			m_context;
+	Search::HeuristicCheck	m_heuristic;
+
+	Node*	m_start;
+	Node*	m_end;
+
+	// index of the expanded node closest to the goal
+	unsigned int	m_best;
+
+	unsigned int	m_excludeFlags;
+
+	// version of the start node's graph when the search began
+	unsigned int	m_version;
+
+	eStatus	m_status;
+};
+
+} // namespace graph
\ No newline at end of file
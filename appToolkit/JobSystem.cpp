@@ -0,0 +1,183 @@
+#include "JobSystem.h"
+
+namespace app {
+
+// which job system a thread works for, and its queue there
+static thread_local const JobSystem* t_jobSystem = nullptr;
+static thread_local unsigned int t_queue = 0;
+
+JobSystem::JobSystem(unsigned int threadCount)
+	: m_queuedCount(0),
+	m_sleepingCount(0),
+	m_quit(false) {
+
+	if (threadCount == 0) {
+		threadCount = std::thread::hardware_concurrency();
+		threadCount = threadCount > 1 ? threadCount - 1 : 1;
+	}
+
+	// the first queue is for threads that aren't workers
+	for (unsigned int i = 0; i <= threadCount; ++i)
+		m_queues.push_back(new Queue());
+
+	for (unsigned int i = 0; i < threadCount; ++i)
+		m_threads.push_back(std::thread(&JobSystem::workerThread, this, i + 1));
+}
+
+JobSystem::~JobSystem() {
+
+	{
+		std::lock_guard<std::mutex> lock(m_sleepMutex);
+		m_quit = true;
+	}
+	m_wake.notify_all();
+
+	for (auto& thread : m_threads)
+		thread.join();
+
+	for (auto queue : m_queues)
+		delete queue;
+}
+
+void JobSystem::parallelFor(unsigned int begin, unsigned int end,
+							const RangeFunction& function, unsigned int grain) {
+
+	if (begin >= end)
+		return;
+
+	unsigned int count = end - begin;
+
+	if (grain == 0) {
+		grain = count / ((unsigned int)m_queues.size() * 8);
+		grain = grain > 0 ? grain : 1;
+	}
+
+	// nothing to share
+	if (count <= grain) {
+		function(begin, end);
+		return;
+	}
+
+	Task task;
+	task.function = &function;
+	task.grain = grain;
+	task.remaining = count;
+
+	unsigned int queue = getQueue();
+
+	run(queue, { &task, begin, end });
+
+	// help with whatever is left, which may be other tasks' jobs,
+	// until the last of this task's ranges has finished
+	while (task.remaining.load(std::memory_order_acquire) > 0) {
+
+		Job job;
+		if (pop(queue, job) ||
+			steal(queue, job))
+			run(queue, job);
+		else
+			std::this_thread::yield();
+	}
+}
+
+void JobSystem::workerThread(unsigned int queue) {
+
+	t_jobSystem = this;
+	t_queue = queue;
+
+	while (true) {
+
+		Job job;
+		if (pop(queue, job) ||
+			steal(queue, job)) {
+			run(queue, job);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(m_sleepMutex);
+
+		// counted as sleeping before checking for jobs, so that a push
+		// either sees a sleeper to wake or is seen by the check
+		++m_sleepingCount;
+		m_wake.wait(lock, [this]() { return m_quit || m_queuedCount > 0; });
+		--m_sleepingCount;
+
+		if (m_quit)
+			return;
+	}
+}
+
+unsigned int JobSystem::getQueue() const {
+	return t_jobSystem == this ? t_queue : 0;
+}
+
+void JobSystem::push(unsigned int queue, const Job& job) {
+
+	// counted first so that taking it can't take the count below 0
+	++m_queuedCount;
+
+	{
+		std::lock_guard<std::mutex> lock(m_queues[queue]->mutex);
+		m_queues[queue]->jobs.push_back(job);
+	}
+
+	// taking the lock means a worker about to sleep is already waiting
+	if (m_sleepingCount > 0) {
+		{ std::lock_guard<std::mutex> lock(m_sleepMutex); }
+		m_wake.notify_one();
+	}
+}
+
+bool JobSystem::pop(unsigned int queue, Job& job) {
+
+	std::lock_guard<std::mutex> lock(m_queues[queue]->mutex);
+
+	auto& jobs = m_queues[queue]->jobs;
+	if (jobs.empty())
+		return false;
+
+	job = jobs.back();
+	jobs.pop_back();
+	--m_queuedCount;
+
+	return true;
+}
+
+bool JobSystem::steal(unsigned int thief, Job& job) {
+
+	unsigned int queueCount = (unsigned int)m_queues.size();
+
+	// start with the next thread along so thieves spread out
+	for (unsigned int i = 1; i < queueCount; ++i) {
+
+		Queue* victim = m_queues[(thief + i) % queueCount];
+
+		std::lock_guard<std::mutex> lock(victim->mutex);
+
+		if (victim->jobs.empty() == false) {
+			job = victim->jobs.front();
+			victim->jobs.pop_front();
+			--m_queuedCount;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void JobSystem::run(unsigned int queue, Job job) {
+
+	while (job.end - job.begin > job.task->grain) {
+
+		unsigned int middle = job.begin + (job.end - job.begin) / 2;
+		push(queue, { job.task, middle, job.end });
+		job.end = middle;
+	}
+
+	(*job.task->function)(job.begin, job.end);
+
+	// the task can be gone as soon as this reaches 0
+	job.task->remaining.fetch_sub(job.end - job.begin, std::memory_order_release);
+}
+
+} // namespace app
\ No newline at end of file
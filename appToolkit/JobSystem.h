@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <vector>
+
+namespace app {
+
+// spreads work across a worker thread per core. Each thread has its own
+// deque of jobs: it takes the newest jobs from the back of its own and,
+// when that is empty, steals the oldest from the front of another's, so
+// work balances itself without every thread contending for one queue.
+// The thread that calls parallelFor() works through jobs as well while
+// it waits, so calls can be nested
+class JobSystem {
+public:
+
+	typedef std::function<void(unsigned int begin, unsigned int end)> RangeFunction;
+
+	// 0 threads will use one less than the hardware thread count,
+	// as the thread calling parallelFor() takes part too
+	JobSystem(unsigned int threadCount = 0);
+	~JobSystem();
+
+	unsigned int getThreadCount() const { return (unsigned int)m_threads.size(); }
+
+	// calls function on ranges of [begin, end) no larger than grain across
+	// the threads, returning once every range is done. A grain of 0 gives
+	// each thread several ranges so that uneven ranges even out
+	void parallelFor(unsigned int begin, unsigned int end,
+					 const RangeFunction& function, unsigned int grain = 0);
+
+protected:
+
+	struct Task {
+		const RangeFunction*		function;
+		unsigned int				grain;
+		std::atomic<unsigned int>	remaining;	// items not yet done
+	};
+
+	struct Job {
+		Task*			task;
+		unsigned int	begin, end;
+	};
+
+	// pushed and popped at the back by its thread, stolen from the front
+	struct Queue {
+		std::mutex			mutex;
+		std::deque<Job>		jobs;
+	};
+
+	void workerThread(unsigned int queue);
+
+	// the queue of the calling thread, with threads that
+	// aren't workers sharing the first
+	unsigned int getQueue() const;
+
+	void push(unsigned int queue, const Job& job);
+	bool pop(unsigned int queue, Job& job);
+	bool steal(unsigned int thief, Job& job);
+
+	// halves the job until it is no larger than its grain, pushing the
+	// halves split off for this thread or others to take, then runs it
+	void run(unsigned int queue, Job job);
+
+	std::vector<Queue*>			m_queues;
+	std::vector<std::thread>	m_threads;
+
+	// workers sleep when there is nothing to take or steal
+	std::mutex					m_sleepMutex;
+	std::condition_variable		m_wake;
+	std::atomic<unsigned int>	m_queuedCount;
+	std::atomic<unsigned int>	m_sleepingCount;
+	bool						m_quit;
+};
+
+} // namespace app
\ No newline at end of file
@@ -25,7 +25,7 @@ unsigned int getPixelColour4(int index, const unsigned char* pixels) {
 }
 
 AIShowcaseApp::AIShowcaseApp() 
-	: m_newPathBehaviour(m_pathNodes) {
+	: m_newPathBehaviour(m_pathNodes, m_pathHierarchy, m_cellNodes, m_pathCache, m_pathRequests) {
 
 }
 
@@ -90,6 +90,9 @@ bool AIShowcaseApp::startup() {
 
 	m_tiles = new int[m_map->getWidth() * m_map->getHeight()];
 
+	m_pathGrid.create(m_map->getWidth(), m_map->getHeight());
+	m_cellNodes.assign(m_map->getWidth() * m_map->getHeight(), nullptr);
+
 	// set tiles and pathfinding graph
 	auto pixels = m_map->getPixels();
 	for (unsigned int y = 0, index = 0; y < m_map->getHeight(); ++y) {
@@ -111,6 +114,9 @@ bool AIShowcaseApp::startup() {
 														  m_map->getWidth(), m_map->getHeight()));
 
 				m_pathNodes.push_back(new MyNode(8 + x * 16.0f, 8 + y * 16.0f));
+
+				m_pathGrid.setWalkable(x, y, true);
+				m_cellNodes[index] = m_pathNodes.back();
 			}
 
 			// add trees to grass tiles
@@ -120,6 +126,9 @@ bool AIShowcaseApp::startup() {
 		}
 	}
 
+	graph::SearchContext context;
+	m_pathHierarchy.build(m_pathGrid, context, PATH_CLUSTER_SIZE);
+
 	// create edges
 	for (auto a : m_pathNodes) {
 		for (auto b : m_pathNodes) {
@@ -130,7 +139,7 @@ bool AIShowcaseApp::startup() {
 
 			if (sqrDist <= (30 * 30)) {
 				graph::Edge* edge = new graph::Edge();
-				edge->cost = sqrDist;
+				edge->cost = sqrt(sqrDist);
 				edge->target = b;
 
 				a->edges.push_back(edge);
@@ -183,7 +192,7 @@ bool AIShowcaseApp::startup() {
 
 		knight.setPosition(node->position);
 
-		knight.getBlackboard().set("path", new std::list<graph::Node*>(), true);
+		knight.getBlackboard().set("path", new graph::Path(), true);
 		knight.getBlackboard().set("velocity", new glm::vec3(0), true);
 		knight.getBlackboard().set("wanderData", new ai::WanderData({ 100,75,25,{0,0,0},{1,1,0} }), true);
 		knight.getBlackboard().set("maxForce", 100.f);
@@ -207,7 +216,10 @@ bool AIShowcaseApp::startup() {
 			auto n = m_pathNodes[rand() % m_pathNodes.size()];
 			entity->setPosition(n->position);
 
-			std::list<graph::Node*>* path = nullptr;
+			// any path still being found is from the old position
+			m_pathRequests.cancel(entity);
+
+			graph::Path* path = nullptr;
 			if (entity->getBlackboard().get("path", &path))
 				path->clear();
 			glm::vec3* velocity = nullptr;
@@ -276,6 +288,9 @@ bool AIShowcaseApp::startup() {
 
 void AIShowcaseApp::shutdown() {
 
+	// stop the workers using the graph before deleting it
+	m_pathRequests.clear();
+
 	for (auto n : m_pathNodes)
 		delete n;
 
@@ -290,6 +305,9 @@ void AIShowcaseApp::shutdown() {
 
 void AIShowcaseApp::update() {
 
+	// hand out paths that the workers have finished
+	m_pathRequests.update(MAX_PATHS_PER_FRAME);
+
 	for (auto& knight : m_knights)
 		knight.executeBehaviours();
 	for (auto& caveman : m_cavemen)
@@ -559,7 +577,7 @@ int getDirtSprite(unsigned char spriteId) {
 ai::eBehaviourResult FollowPathBehaviour::execute(ai::Agent* entity) {
 
 	// access data from the game object
-	std::list<graph::Node*>* path = nullptr;
+	graph::Path* path = nullptr;
 	if (entity->getBlackboard().get("path", &path) == false ||
 		path->empty())
 		return ai::eBehaviourResult::FAILURE;
@@ -583,7 +601,7 @@ ai::eBehaviourResult FollowPathBehaviour::execute(ai::Agent* entity) {
 	}
 	else {
 		// at the node, remove it and move to the next
-		path->pop_front();
+		path->popFront();
 	}
 	return ai::eBehaviourResult::SUCCESS;
 }
@@ -610,22 +628,39 @@ MyNode* NewPathBehaviour::findClosest(const glm::vec3& p) {
 ai::eBehaviourResult NewPathBehaviour::execute(ai::Agent* entity) {
 
 	// access data from the game object
-	std::list<graph::Node*>* path = nullptr;
+	graph::Path* path = nullptr;
 	if (entity->getBlackboard().get("path", &path) == false)
 		return ai::eBehaviourResult::FAILURE;
 
-	auto position = entity->getPosition();
-
-	// random end node
-	bool found = false;
-	do {
-
-		auto start = findClosest(position);
-		auto end = m_nodes[rand() % m_nodes.size()];
-
-		found = graph::Search::aStar(start, end, *path, MyNode::heuristic);
-
-	} while (found == false);
+	// this tree is shared by every agent so it can't return RUNNING
+	// while waiting, it just succeeds until the path is delivered
+	if (m_pathRequests.isPending(entity) ||
+		path->empty() == false)
+		return ai::eBehaviourResult::SUCCESS;
+
+	// random end node, if no path is found then the path stays
+	// empty and a new request is made next time
+	auto start = findClosest(entity->getPosition());
+	auto end = m_nodes[rand() % m_nodes.size()];
+
+	// each node sits in the middle of a 16 pixel tile
+	int startX = int(start->position.x / 16);
+	int startY = int(start->position.y / 16);
+	int endX = int(end->position.x / 16);
+	int endY = int(end->position.y / 16);
+
+	auto& hierarchy = m_hierarchy;
+	auto& cellNodes = m_cellNodes;
+	auto& pathCache = m_pathCache;
+
+	auto search = [&hierarchy, &cellNodes, startX, startY, endX, endY](graph::SearchContext& context, graph::Path& path) {
+		return hierarchy.findPath(context, startX, startY, endX, endY, cellNodes, path);
+	};
+
+	m_pathRequests.submit(entity,
+						  [&pathCache, start, end, search](graph::SearchContext& context, graph::Path& path) {
+							  return pathCache.findPath(context, start, end, 0, search, path);
+						  });
 
 	return ai::eBehaviourResult::SUCCESS;
 }
@@ -5,10 +5,14 @@
 #include "Texture.h"
 #include "Timing.h"
 #include "Pathfinding.h"
+#include "HierarchicalGrid.h"
+#include "PathCache.h"
+#include "Heuristics.h"
 #include "Agent.h"
 #include "Behaviour.h"
 #include "BehaviourTree.h"
 #include "SteeringBehaviour.h"
+#include "PathRequestQueue.h"
 
 enum eSprites {
 	SPRITE_GRASS = 0,
@@ -70,14 +74,14 @@ public:
 	MyNode(float x, float y, float z = 0) : position(x,y,z) {}
 	virtual ~MyNode() {}
 
+	// octile distance, as the nodes form an 8-connected grid
+	// with edges costing their length
 	static float heuristic(Node* a, Node* b) {
 
 		MyNode* s = (MyNode*)a;
 		MyNode* e = (MyNode*)b;
 
-		auto diff = e->position - s->position;
-
-		return glm::dot(diff, diff);
+		return graph::Heuristics::octile(e->position.x - s->position.x, e->position.y - s->position.y);
 	}
 	
 	glm::vec3 position;
@@ -109,10 +113,19 @@ public:
 	virtual ai::eBehaviourResult execute(ai::Agent* entity);
 };
 
+// requests a path to a random node, which is solved by the
+// path request workers and written into the path on a later frame.
+// The workers search the road clusters first so that long paths
+// don't have to spread over every road tile, and reuse any path
+// already found between the same two tiles
 class NewPathBehaviour : public ai::Behaviour {
 public:
 
-	NewPathBehaviour(std::vector<MyNode*>& nodes) : m_nodes(nodes) {}
+	NewPathBehaviour(std::vector<MyNode*>& nodes, graph::HierarchicalGrid& hierarchy,
+					 std::vector<graph::Node*>& cellNodes, graph::PathCache& pathCache,
+					 ai::PathRequestQueue& pathRequests)
+		: m_nodes(nodes), m_hierarchy(hierarchy), m_cellNodes(cellNodes),
+		m_pathCache(pathCache), m_pathRequests(pathRequests) {}
 	virtual ~NewPathBehaviour() {}
 
 	virtual ai::eBehaviourResult execute(ai::Agent* entity);
@@ -122,6 +135,10 @@ protected:
 	MyNode* findClosest(const glm::vec3& p);
 
 	std::vector<MyNode*>& m_nodes;
+	graph::HierarchicalGrid& m_hierarchy;
+	std::vector<graph::Node*>& m_cellNodes;
+	graph::PathCache& m_pathCache;
+	ai::PathRequestQueue& m_pathRequests;
 };
 
 class WaterAvoidanceForce : public ai::SteeringForce {
@@ -199,7 +216,7 @@ public:
 			auto position = entity->getPosition();
 
 			for (auto& t : *targets) {
-				auto target = t.getPosition();
+				auto target = t.getSharedPosition();
 				auto diff = position - target;
 
 				float dist = glm::dot(diff, diff);
@@ -229,7 +246,7 @@ public:
 			target != nullptr) {
 
 			auto position = entity->getPosition();
-			auto targetPos = target->getPosition();
+			auto targetPos = target->getSharedPosition();
 			auto diff = position - targetPos;
 			
 			if (glm::dot(diff, diff) <= (attackRange * attackRange))
@@ -253,7 +270,7 @@ public:
 			target != nullptr) {
 
 			auto position = entity->getPosition();
-			auto targetPos = target->getPosition();
+			auto targetPos = target->getSharedPosition();
 			auto diff = position - targetPos;
 
 			if (glm::dot(diff, diff) <= (chaseRange * chaseRange))
@@ -349,11 +366,29 @@ protected:
 
 	std::vector<MyNode*>	m_pathNodes;
 
+	// the walkable road tiles, and the node on each road tile
+	graph::Grid					m_pathGrid;
+	std::vector<graph::Node*>	m_cellNodes;
+
+	// road clusters and the entrances between them
+	graph::HierarchicalGrid		m_pathHierarchy;
+
+	enum { PATH_CLUSTER_SIZE = 10 };
+
+	// recent knight paths, shared by the path request workers
+	graph::PathCache			m_pathCache;
+
+	// solves knight paths on worker threads
+	ai::PathRequestQueue	m_pathRequests;
+
 	enum eEntityType {
 		KNIGHT = 0,
 		CAVEMAN,
 	};
 
+	// limits how many finished paths are handed to knights each frame
+	enum { MAX_PATHS_PER_FRAME = 8 };
+
 	std::vector<ai::Agent> m_knights;
 	std::vector<ai::Agent> m_cavemen;
 
@@ -18,19 +18,17 @@ bool FlockingApp::startup() {
 	
 	m_entities.resize(400);
 
-	m_separation.setEntities(&m_entities);
-	m_separation.setRadius(100);
+	// cells the size of the neighbour radius
+	m_grid.setCellSize(100);
 
-	m_cohesion.setEntities(&m_entities);
-	m_cohesion.setRadius(100);
-
-	m_alignment.setEntities(&m_entities);
-	m_alignment.setRadius(100);
+	// separation, cohesion and alignment together
+	m_flocking.setEntities(&m_entities);
+	m_flocking.setRadius(100);
+	m_flocking.setGrid(&m_grid);
+	m_flocking.setWeights(1.25f, 1, 1);
 
 	m_steeringBehaviour.addForce(&m_wander, 1);
-	m_steeringBehaviour.addForce(&m_separation, 1.25f);
-	m_steeringBehaviour.addForce(&m_cohesion, 1);
-	m_steeringBehaviour.addForce(&m_alignment, 1);
+	m_steeringBehaviour.addForce(&m_flocking, 1);
 
 	for (auto& entity : m_entities) {
 
@@ -49,6 +47,7 @@ bool FlockingApp::startup() {
 		wd->jitter = 25;
 		wd->target = { 0 };
 		wd->axisWeights = { 1, 1, 0 };
+		wd->randomState = (unsigned int)m_rand.next() + 1;
 		entity.getBlackboard().set("wanderData", wd, true);
 
 		entity.addBehaviour(&m_steeringBehaviour);
@@ -68,8 +67,15 @@ void FlockingApp::shutdown() {
 
 void FlockingApp::update() {
 
-	for (auto& entity : m_entities)
-		entity.executeBehaviours();
+	// neighbours are found from where everyone was before this update
+	m_grid.build(m_entities);
+
+	if (m_parallel)
+		ai::Agent::executeBehaviours(m_jobs, m_entities);
+	else {
+		for (auto& entity : m_entities)
+			entity.executeBehaviours();
+	}
 
 	// input example
 	app::Input* input = app::Input::getInstance();
@@ -77,6 +83,9 @@ void FlockingApp::update() {
 	// exit the application
 	if (input->isKeyDown(app::INPUT_KEY_ESCAPE))
 		quit();
+
+	if (input->wasKeyPressed(app::INPUT_KEY_P))
+		m_parallel = !m_parallel;
 }
 
 void FlockingApp::draw() {
@@ -99,7 +108,8 @@ void FlockingApp::draw() {
 	}
 	
 	// output some text
-	m_2dRenderer->drawText(m_font, "Press ESC to quit", 0, 0);
+	m_2dRenderer->drawText(m_font, m_parallel ? "Press ESC to quit, P = toggle parallel (on)" :
+											  "Press ESC to quit, P = toggle parallel (off)", 0, 0);
 
 	// done drawing sprites
 	m_2dRenderer->end();
@@ -5,6 +5,8 @@
 #include "Random.h"
 #include "Agent.h"
 #include "SteeringBehaviour.h"
+#include "SpatialGrid.h"
+#include "JobSystem.h"
 
 class FlockingApp : public app::Application {
 public:
@@ -24,13 +26,16 @@ protected:
 	app::Font*			m_font;
 
 	std::vector<ai::Agent>	m_entities;
+	ai::SpatialGrid			m_grid;
 
 	ai::SteeringBehaviour	m_steeringBehaviour;
 
 	ai::WanderForce			m_wander;
-	ai::SeparationForce		m_separation;
-	ai::CohesionForce		m_cohesion;
-	ai::AlignmentForce		m_alignment;
+	ai::FlockingForce		m_flocking;
 
 	app::Random				m_rand;
+
+	// updates the boids across every core
+	app::JobSystem			m_jobs;
+	bool					m_parallel = false;
 };
\ No newline at end of file
@@ -45,11 +45,13 @@ bool FlowFieldsApp::startup() {
 	// (could instead generate from an image)
 	randomiseLevel(m_obstaclePercentage);
 
-	m_flowForce.setField(&(m_flowField[0][0][0]),
-						 FLOWFIELD_ROWS, FLOWFIELD_COLS, 1,
-						 FLOWFIELD_CELLSIZE);
+	m_flowForce.setField(&m_flowCache, m_goal, FLOWFIELD_CELLSIZE);
 
+	m_sectorFlowForce.setField(&m_sectorField, FLOWFIELD_CELLSIZE);
+
+	// only one of the flow forces is weighted at a time
 	m_steeringBehaviour.addForce(&m_flowForce);
+	m_steeringBehaviour.addForce(&m_sectorFlowForce, 0);
 
 	for (auto& go : m_entitys) {
 
@@ -89,6 +91,19 @@ void FlowFieldsApp::update() {
 	if (input->wasKeyPressed(app::INPUT_KEY_C))
 		m_drawHSL = !m_drawHSL;
 
+	// smooth eikonal integration or 8 way, cached fields integrate again
+	if (input->wasKeyPressed(app::INPUT_KEY_E)) {
+		m_eikonal = !m_eikonal;
+		m_flowCache.setEikonal(m_eikonal);
+	}
+
+	// whole field or sectors made as agents reach them
+	if (input->wasKeyPressed(app::INPUT_KEY_S)) {
+		m_sectors = !m_sectors;
+		m_steeringBehaviour.setWeightForForce(&m_flowForce, m_sectors ? 0.0f : 1.0f);
+		m_steeringBehaviour.setWeightForForce(&m_sectorFlowForce, m_sectors ? 1.0f : 0.0f);
+	}
+
 	// randomise level
 	glm::vec3* velocity = nullptr;
 	if (input->wasKeyPressed(app::INPUT_KEY_R)) {
@@ -111,10 +126,24 @@ void FlowFieldsApp::update() {
 		y /= FLOWFIELD_CELLSIZE;
 
 		// error!
-		if (m_costField[y][x] != eFlowFieldCosts::IMPASSABLE) {
-			
-			performIntergration(x, y);
-			generateFlowfield();
+		if (m_flowField.isPassable(x, y)) {
+
+			// acquired before the old goal is released so that
+			// holding the button on one cell keeps its field
+			auto goal = m_flowCache.acquire(x, y);
+			m_flowCache.release(m_goal);
+			m_goal = goal;
+
+			m_flowForce.setField(&m_flowCache, m_goal, FLOWFIELD_CELLSIZE);
+
+			// the sectored field only searches its portals until agents need flow
+			if (x != m_goalX || y != m_goalY) {
+				m_sectorField.removeGoal(m_goalX, m_goalY);
+				m_sectorField.addGoal(x, y);
+				m_sectorFlowForce.setGoal(x, y);
+				m_goalX = x;
+				m_goalY = y;
+			}
 		}
 	}
 }
@@ -127,10 +156,13 @@ void FlowFieldsApp::draw() {
 	// begin drawing sprites
 	m_2dRenderer->begin();
 
+	const ai::FlowField* field = m_flowCache.getField(m_goal);
+	m_maxCost = field != nullptr ? field->getMaxIntegration() : 0;
+
 	// draw obstacles
 	for (int r = 0; r < FLOWFIELD_ROWS; ++r) {
 		for (int c = 0; c < FLOWFIELD_COLS; ++c) {
-			if (m_costField[r][c] == eFlowFieldCosts::IMPASSABLE) {
+			if (m_flowField.isPassable(c, r) == false) {
 				m_2dRenderer->setRenderColour(1, 1, 1);
 				m_2dRenderer->drawBox(FLOWFIELD_CELLSIZE * 0.5f + c * FLOWFIELD_CELLSIZE,
 									  FLOWFIELD_CELLSIZE * 0.5f + r * FLOWFIELD_CELLSIZE,
@@ -142,10 +174,19 @@ void FlowFieldsApp::draw() {
 			}
 			else {
 
-				if (m_drawGradient) {
+				// sectors only have integration and flow once agents reach them
+				bool generated = m_sectors ?
+					m_sectorField.isSectorGenerated(m_goalX, m_goalY, m_sectorField.getSector(c, r)) :
+					field != nullptr;
+
+				if (m_drawGradient && generated) {
+
+					float integration = m_sectors ?
+						m_sectorField.getIntegration(m_goalX, m_goalY, c, r) :
+						field->getIntegration(c, r);
 
 					// greyscale
-					float colour = m_integrationField[r][c] / m_maxCost;
+					float colour = integration / m_maxCost;
 
 					// greyscale to rgb
 					float red, green, blue;
@@ -161,12 +202,15 @@ void FlowFieldsApp::draw() {
 										  FLOWFIELD_CELLSIZE, FLOWFIELD_CELLSIZE);
 				}
 
-				if (m_drawFlow) {
+				if (m_drawFlow && generated) {
+					auto& flow = m_sectors ?
+						m_sectorField.getFlow(m_goalX, m_goalY, c, r) :
+						field->getFlow(c, r);
 					m_2dRenderer->setRenderColour(1, 1, 0);
 					m_2dRenderer->drawLine(FLOWFIELD_CELLSIZE * 0.5f + c * FLOWFIELD_CELLSIZE,
 										   FLOWFIELD_CELLSIZE * 0.5f + r * FLOWFIELD_CELLSIZE,
-										   FLOWFIELD_CELLSIZE * 0.5f + c * FLOWFIELD_CELLSIZE + m_flowField[r][c][0].x * 16,
-										   FLOWFIELD_CELLSIZE * 0.5f + r * FLOWFIELD_CELLSIZE + m_flowField[r][c][0].y * 16);
+										   FLOWFIELD_CELLSIZE * 0.5f + c * FLOWFIELD_CELLSIZE + flow.x * 16,
+										   FLOWFIELD_CELLSIZE * 0.5f + r * FLOWFIELD_CELLSIZE + flow.y * 16);
 				}
 			}
 		}
@@ -180,7 +224,7 @@ void FlowFieldsApp::draw() {
 	}
 
 	m_2dRenderer->setRenderColour(1, 1, 0);
-	m_2dRenderer->drawText(m_font, "G = toggle gradient, F = toggle flow, C = toggle colour", 0, 0, -1);
+	m_2dRenderer->drawText(m_font, "G = toggle gradient, F = toggle flow, C = toggle colour, E = toggle eikonal, S = toggle sectors", 0, 0, -1);
 	
 	// done drawing sprites
 	m_2dRenderer->end();
@@ -188,6 +232,17 @@ void FlowFieldsApp::draw() {
 
 void FlowFieldsApp::randomiseLevel(float obstaclePercentage) {
 
+	// forgets the goal so agents wait for a new one
+	m_flowCache.release(m_goal);
+	m_goal = ai::FlowFieldCache::INVALID_HANDLE;
+	m_flowForce.setField(&m_flowCache, m_goal, FLOWFIELD_CELLSIZE);
+
+	m_flowField.create(FLOWFIELD_COLS, FLOWFIELD_ROWS);
+	m_sectorField.create(FLOWFIELD_COLS, FLOWFIELD_ROWS, FLOWFIELD_SECTORSIZE);
+	m_sectorFlowForce.setGoal(-1, -1);
+	m_goalX = m_goalY = -1;
+	m_maxCost = 0;
+
 	// randomly place obstacles
 	for (int r = 0; r < FLOWFIELD_ROWS; ++r) {
 		for (int c = 0; c < FLOWFIELD_COLS; ++c) {			
@@ -196,222 +251,27 @@ void FlowFieldsApp::randomiseLevel(float obstaclePercentage) {
 			//if (rand() % 100 < int(100 * obstaclePercentage))
 
 			if (m_map->getPixels()[r * FLOWFIELD_COLS + c] == 0)
-				m_costField[r][c] = eFlowFieldCosts::IMPASSABLE;
+				m_flowField.setCost(c, r, ai::FlowField::IMPASSABLE);
 			else
-				m_costField[r][c] = eFlowFieldCosts::WALKABLE;
+				m_flowField.setCost(c, r, ai::FlowField::WALKABLE);
 
-			m_integrationField[r][c] = 0;
-			m_flowField[r][c][0].x = 0;
-			m_flowField[r][c][0].y = 0;
-			m_flowField[r][c][0].z = 0;
+			m_sectorField.setCost(c, r, m_flowField.getCost(c, r));
 		}
 	}
 
+	m_sectorField.buildPortals();
+
+	// cached fields for other goals are integrated again if used
+	m_flowCache.setCosts(m_flowField);
+
 	// safely place game objects
 	for (auto& go : m_entitys) {
 		int index = 0;
 		do {
 			index = rand() % (FLOWFIELD_ROWS * FLOWFIELD_COLS);
-		} while (m_costField[index / FLOWFIELD_COLS][index % FLOWFIELD_COLS] == eFlowFieldCosts::IMPASSABLE);
+		} while (m_flowField.isPassable(index % FLOWFIELD_COLS, index / FLOWFIELD_COLS) == false);
 
 		go.setPosition({ FLOWFIELD_CELLSIZE * 0.5f + (index % FLOWFIELD_COLS) * FLOWFIELD_CELLSIZE,
 					   FLOWFIELD_CELLSIZE * 0.5f + (index / FLOWFIELD_COLS) * FLOWFIELD_CELLSIZE, 0.0f });
 	}
-}
-
-void FlowFieldsApp::getCellNeighbours(int x, int y, std::vector<int>& neighbours) {
-
-	neighbours.clear();
-
-	// down
-	if (y > 0 &&
-		m_costField[y - 1][x] != eFlowFieldCosts::IMPASSABLE) {
-		neighbours.push_back(x);
-		neighbours.push_back(y - 1);
-	}
-	// up
-	if (y < (FLOWFIELD_ROWS - 1) &&
-		m_costField[y + 1][x] != eFlowFieldCosts::IMPASSABLE) {
-		neighbours.push_back(x);
-		neighbours.push_back(y + 1);
-	}
-	// left
-	if (x > 0 &&
-		m_costField[y][x - 1] != eFlowFieldCosts::IMPASSABLE) {
-		neighbours.push_back(x - 1);
-		neighbours.push_back(y);
-
-		// down diag
-		if (y > 0 &&
-			m_costField[y - 1][x - 1] != eFlowFieldCosts::IMPASSABLE &&
-			m_costField[y - 1][x] != eFlowFieldCosts::IMPASSABLE) {
-			neighbours.push_back(x - 1);
-			neighbours.push_back(y - 1);
-		}
-		// up diag
-		if (y < (FLOWFIELD_ROWS - 1) &&
-			m_costField[y + 1][x - 1] != eFlowFieldCosts::IMPASSABLE &&
-			m_costField[y + 1][x] != eFlowFieldCosts::IMPASSABLE) {
-			neighbours.push_back(x - 1);
-			neighbours.push_back(y + 1);
-		}
-	}
-	// right
-	if (x < (FLOWFIELD_COLS - 1) &&
-		m_costField[y][x + 1] != eFlowFieldCosts::IMPASSABLE) {
-		neighbours.push_back(x + 1);
-		neighbours.push_back(y);
-
-		// down diag
-		if (y > 0 &&
-			m_costField[y - 1][x + 1] != eFlowFieldCosts::IMPASSABLE &&
-			m_costField[y - 1][x] != eFlowFieldCosts::IMPASSABLE) {
-			neighbours.push_back(x + 1);
-			neighbours.push_back(y - 1);
-		}
-		// up diag
-		if (y < (FLOWFIELD_ROWS - 1) &&
-			m_costField[y + 1][x + 1] != eFlowFieldCosts::IMPASSABLE &&
-			m_costField[y + 1][x] != eFlowFieldCosts::IMPASSABLE) {
-			neighbours.push_back(x + 1);
-			neighbours.push_back(y + 1);
-		}
-	}
-
-	// 8 potential neighbours
-	// This creates diagonals through corners with impassable
-	/*for (int r = -1; r <= 1; ++r) {
-		for (int c = -1; c <= 1; ++c) {
-			if (x == c &&
-				y == r)
-				continue;
-
-			if ((x + c) >= 0 &&
-				(x + c) <= (FLOWFIELD_COLS - 1) &&
-				(y + r) >= 0 &&
-				(y + r) <= (FLOWFIELD_ROWS - 1) &&
-				m_costField[y + r][x + c] != eFlowFieldCosts::IMPASSABLE) {
-
-				// but can we reach it?
-				neighbours.push_back(x + c);
-				neighbours.push_back(y + r);
-			}
-		}
-	}*/
-}
-
-void FlowFieldsApp::performIntergration(int goalX, int goalY) {
-	// perform a dijkstra's search towards goal cell, 
-	// starting from goal cell spreading outwards
-
-	// reset field
-	for (int r = 0; r < FLOWFIELD_ROWS; ++r) {
-		for (int c = 0; c < FLOWFIELD_COLS; ++c) {
-			m_integrationField[r][c] = FLT_MAX;
-		}
-	}
-
-	// start open list
-	std::list<std::pair<int, int>> openList;
-	openList.push_back({ goalX, goalY });
-
-	m_integrationField[goalY][goalX] = 0;
-
-	std::vector<int> neighbours(16);
-
-	m_maxCost = 0;
-
-	// do reverse dijkstra
-	while (openList.empty() == false) {
-
-		auto current = openList.front();
-		openList.pop_front();
-
-		int x = current.first;
-		int y = current.second;
-
-		getCellNeighbours(x, y, neighbours);
-		
-		unsigned int neighbourCount = neighbours.size();
-
-		// add neighbours to open list
-		for (unsigned int i = 0; i < neighbourCount; i += 2) {
-
-			int nx = neighbours[i];
-			int ny = neighbours[i + 1];
-
-			float modifier = 1;
-
-			if (x != nx &&
-				y != ny)
-				modifier = 1.5f;
-
-			float cost = m_integrationField[y][x] + m_costField[ny][nx] * modifier;
-
-			if (cost > m_maxCost)
-				m_maxCost = cost;
-
-			if (cost < m_integrationField[ny][nx]) {
-
-				m_integrationField[ny][nx] = cost;
-
-				std::pair<int, int> neighbour = { nx, ny };
-
-				// is neighbour on open list?
-				auto iter = std::find(openList.begin(), openList.end(), neighbour);
-				if (iter == openList.end())
-					openList.push_back(neighbour);
-			}
-		}
-	}
-}
-
-void FlowFieldsApp::generateFlowfield() {
-	// for each grid cell, sample neighbour costs and 
-	// setup flow direction to lowest cost neighbour
-
-	std::vector<int> neighbours(16);
-	int x, y; // lowest X and Y for the neighbour
-	float lowestCost;
-
-	for (int r = 0; r < FLOWFIELD_ROWS; ++r) {
-		for (int c = 0; c < FLOWFIELD_COLS; ++c) {
-
-			m_flowField[r][c][0].x = 0;
-			m_flowField[r][c][0].y = 0;
-			m_flowField[r][c][0].z = 0;
-
-			lowestCost = FLT_MAX;
-
-			getCellNeighbours(c, r, neighbours);
-
-			unsigned int neighbourCount = neighbours.size();
-
-			if (neighbourCount > 0) {
-
-				// find bet neighbour
-				for (unsigned int i = 0; i < neighbourCount; i += 2) {
-
-					int nx = neighbours[i];
-					int ny = neighbours[i + 1];
-
-					if (m_integrationField[ny][nx] <= lowestCost) {
-						lowestCost = m_integrationField[ny][nx];
-						x = nx;
-						y = ny;
-					}
-				}
-
-				float mag = float((x - c) * (x - c) + (y - r) * (y - r));
-
-				if (mag > 0) {
-					mag = sqrt(mag);
-
-					m_flowField[r][c][0].x = (x - c) / mag;
-					m_flowField[r][c][0].y = (y - r) / mag;
-					m_flowField[r][c][0].z = 0;
-				}
-			}
-		}
-	}
 }
\ No newline at end of file
@@ -5,6 +5,9 @@
 
 #include "Agent.h"
 #include "SteeringBehaviour.h"
+#include "FlowField.h"
+#include "FlowFieldCache.h"
+#include "SectorFlowField.h"
 #include "Texture.h"
 
 class FlowFieldsApp : public app::Application {
@@ -30,11 +33,7 @@ protected:
 
 	ai::SteeringBehaviour	m_steeringBehaviour;
 	ai::FlowForce			m_flowForce;
-	
-	enum eFlowFieldCosts : unsigned short {
-		WALKABLE = 1,
-		IMPASSABLE = 0xffff,
-	};
+	ai::SectorFlowForce		m_sectorFlowForce;
 	
 	enum eFlowFieldSize {
 		FLOWFIELD_ROWS = 23,
@@ -42,14 +41,23 @@ protected:
 		FLOWFIELD_CELLSIZE = 32,
 	};
 
-	// contains movement costs through the field
-	unsigned short	m_costField[FLOWFIELD_ROWS][FLOWFIELD_COLS];
+	// movement costs
+	ai::FlowField	m_flowField;
 
-	// contains actual travel cost to goal cell
-	float			m_integrationField[FLOWFIELD_ROWS][FLOWFIELD_COLS];
+	// travel cost to the goal cell and the vectors that travel towards
+	// it, kept per goal so that picking an earlier goal again reuses it
+	ai::FlowFieldCache			m_flowCache;
+	ai::FlowFieldCache::Handle	m_goal = ai::FlowFieldCache::INVALID_HANDLE;
 
-	// the vector flow field that travels towards the goal cell
-	glm::vec3			m_flowField[FLOWFIELD_ROWS][FLOWFIELD_COLS][1];
+	// the same costs split into sectors that are only integrated
+	// as agents reach them, used when m_sectors is set
+	ai::SectorFlowField	m_sectorField;
+	int m_goalX = -1, m_goalY = -1;
+	bool m_sectors = false;
+
+	enum {
+		FLOWFIELD_SECTORSIZE = 8,
+	};
 
 	// percentage of grid taken up by obstacles
 	float m_obstaclePercentage = 0.15f;
@@ -57,20 +65,12 @@ protected:
 	// randomly generates obstacles and places entities safely
 	void randomiseLevel(float obstaclePercentage);
 
-	// the neighbours parameter will be filled with 2x int for 
-	// every neighbour ([y][x] within the field)
-	// ignores impassable neighbours
-	void getCellNeighbours(int x, int y, std::vector<int>& neighbours);
-
-	// generate dijkstras to goal cell
-	void performIntergration(int goalX, int goalY);
-
-	// calculate flow based on gScores
-	void generateFlowfield();
-
 	// visualisation stuff
 	float m_maxCost = 0;
 	bool m_drawFlow = false;
 	bool m_drawGradient = false;
 	bool m_drawHSL = false;
+
+	// integrate with integrateEikonal() and generateGradientFlow()
+	bool m_eikonal = false;
 };
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include "Timing.h"
 #include "poly2tri/poly2tri.h"
 
+#include <algorithm>
+
 NavMesh::NavMesh(float width, float height) {
 
 	m_polygons.push_back({});
@@ -102,8 +104,8 @@ void NavMesh::build() {
 					(n->position.y - n2->position.y) *
 					(n->position.y - n2->position.y);
 
-				n->edges.push_back(new graph::Edge(n2, 1));
-				n2->edges.push_back(new graph::Edge(n, 1));
+				// the pair is visited both ways round, so only link one way
+				n->edges.push_back(new graph::Edge(n2, sqrt(mag)));
 			}
 		}
 	}
@@ -122,7 +124,7 @@ void NavMesh::build() {
 ai::eBehaviourResult NavMesh::FollowPathBehaviour::execute(ai::Agent* entity) {
 
 	// access data from the game object
-	std::list<glm::vec3>* smoothPath = nullptr;
+	graph::BasicPath<glm::vec3>* smoothPath = nullptr;
 	if (entity->getBlackboard().get("smoothpath", &smoothPath) == false ||
 		smoothPath->empty())
 		return ai::eBehaviourResult::FAILURE;
@@ -146,7 +148,7 @@ ai::eBehaviourResult NavMesh::FollowPathBehaviour::execute(ai::Agent* entity) {
 	}
 	else {
 		// at the node, remove it and move to the next
-		smoothPath->pop_front();
+		smoothPath->popFront();
 	}
 	return ai::eBehaviourResult::SUCCESS;
 }
@@ -154,32 +156,107 @@ ai::eBehaviourResult NavMesh::FollowPathBehaviour::execute(ai::Agent* entity) {
 ai::eBehaviourResult NavMesh::NewPathBehaviour::execute(ai::Agent* entity) {
 
 	// access data from the game object
-	std::list<graph::Node*>* path = nullptr;
+	graph::Path* path = nullptr;
 	if (entity->getBlackboard().get("path", &path) == false)
 		return ai::eBehaviourResult::FAILURE;
 
-	std::list<glm::vec3>* smoothPath = nullptr;
+	graph::BasicPath<glm::vec3>* smoothPath = nullptr;
 	if (entity->getBlackboard().get("smoothpath", &smoothPath) == false)
 		return ai::eBehaviourResult::FAILURE;
 
+	// still waiting on the workers
+	if (m_pathRequests != nullptr &&
+		m_pathRequests->isPending(entity))
+		return ai::eBehaviourResult::SUCCESS;
+
 	auto position = entity->getPosition();
 
 	// random end node
-	bool found = false;
-	do {
+	auto first = m_navMesh->findClosest(position);
+	auto end = first;
+	while (end == first)
+		end = m_navMesh->getRandomNode();
+
+	if (m_pathRequests != nullptr) {
+
+		// smooth the path once it has been delivered, if no path
+		// was found the smooth path stays empty and we try again
+		m_pathRequests->submit(entity, first, end, NavMesh::Node::heuristic, 0,
+			[](ai::Agent* agent, bool found) {
+			graph::Path* p = nullptr;
+			graph::BasicPath<glm::vec3>* s = nullptr;
+			if (found &&
+				agent->getBlackboard().get("path", &p) &&
+				agent->getBlackboard().get("smoothpath", &s))
+				NavMesh::smoothPath(*p, *s);
+		});
+
+		return ai::eBehaviourResult::SUCCESS;
+	}
+
+	if (graph::Search::aStar(m_context, first, end, *path, NavMesh::Node::heuristic) == false)
+		return ai::eBehaviourResult::FAILURE;
+
+	NavMesh::smoothPath(*path, *smoothPath);
+
+	return ai::eBehaviourResult::SUCCESS;
+}
+
+ai::eBehaviourResult NavMesh::SlicedPathBehaviour::execute(ai::Agent* entity) {
 
-		auto first = m_navMesh->findClosest(position);
+	// access data from the game object
+	graph::Path* path = nullptr;
+	if (entity->getBlackboard().get("path", &path) == false)
+		return ai::eBehaviourResult::FAILURE;
+
+	graph::BasicPath<glm::vec3>* smoothPath = nullptr;
+	if (entity->getBlackboard().get("smoothpath", &smoothPath) == false)
+		return ai::eBehaviourResult::FAILURE;
+
+	// the agent owns its search
+	graph::TimeSlicedAStar* search = nullptr;
+	if (entity->getBlackboard().get("search", &search) == false) {
+		search = new graph::TimeSlicedAStar();
+		entity->getBlackboard().set("search", search, true);
+	}
+
+	// a search was cancelled for a path given some other way,
+	// such as by the player clicking, so follow that instead
+	if (search->isSearching() == false &&
+		smoothPath->empty() == false)
+		return ai::eBehaviourResult::SUCCESS;
+
+	// random end node
+	if (search->isSearching() == false) {
+		auto first = m_navMesh->findClosest(entity->getPosition());
 		auto end = first;
 		while (end == first)
 			end = m_navMesh->getRandomNode();
 
-		found = graph::Search::aStar(first, end, *path, NavMesh::Node::heuristic);
+		search->begin(first, end, NavMesh::Node::heuristic);
+	}
+
+	auto status = search->step(m_expansionsPerFrame);
+
+	search->getBestPath(*path);
 
-	} while (found == false);
+	// skip the nodes the agent has already passed on the
+	// way along an earlier partial path
+	auto current = m_navMesh->findClosest(entity->getPosition());
+	if (std::find(path->begin(), path->end(), current) != path->end()) {
+		while (path->front() != current)
+			path->popFront();
+	}
 
 	NavMesh::smoothPath(*path, *smoothPath);
 
-	return ai::eBehaviourResult::SUCCESS;
+	if (status == graph::TimeSlicedAStar::SEARCHING)
+		return ai::eBehaviourResult::RUNNING;
+
+	// ready for a new search next time
+	search->cancel();
+
+	return status == graph::TimeSlicedAStar::FOUND ? ai::eBehaviourResult::SUCCESS : ai::eBehaviourResult::FAILURE;
 }
 
 int NavMesh::stringPull(const glm::vec3* portals, int portalCount,
@@ -271,15 +348,19 @@ int NavMesh::stringPull(const glm::vec3* portals, int portalCount,
 	return npts;
 }
 
-size_t NavMesh::smoothPath(const std::list<graph::Node*>& path,
-						std::list<glm::vec3>& smoothPath) {
+size_t NavMesh::smoothPath(const graph::Path& path,
+						graph::BasicPath<glm::vec3>& smoothPath) {
+
+	smoothPath.clear();
 
-	if (path.size() == 0)
+	if (path.empty())
 		return 0;
 
-	smoothPath.clear();
+	// scratch space kept between calls so smoothing doesn't allocate
+	static thread_local std::vector<glm::vec3> portals;
+	static thread_local std::vector<glm::vec3> out;
 
-	glm::vec3* portals = new glm::vec3[(path.size() + 1) * 2];
+	portals.resize((path.size() + 1) * 2);
 
 	int index = 0;
 
@@ -319,14 +400,30 @@ size_t NavMesh::smoothPath(const std::list<graph::Node*>& path,
 	portals[index++] = ((NavMesh::Node*)path.back())->position;
 	portals[index++] = ((NavMesh::Node*)path.back())->position;
 
-	// shorten path through portals
-	glm::vec3 out[100];
-	int count = stringPull(portals, index / 2, out, 100);
+	// shorten path through portals, every point is a portal
+	// vertex so there can't be more points than portals
+	out.resize(index);
+	int count = stringPull(portals.data(), index / 2, out.data(), index);
 
 	for (int i = 0; i < count; ++i)
-		smoothPath.push_back(out[i]);
-
-	delete[] portals;
+		smoothPath.pushBack(out[i]);
 	
+	return smoothPath.size();
+}
+
+size_t NavMesh::smoothPath(const std::list<graph::Node*>& path,
+						std::list<glm::vec3>& smoothPath) {
+
+	smoothPath.clear();
+
+	graph::Path nodes;
+	for (auto n : path)
+		nodes.pushBack(n);
+
+	graph::BasicPath<glm::vec3> smooth;
+	NavMesh::smoothPath(nodes, smooth);
+
+	smoothPath.assign(smooth.begin(), smooth.end());
+
 	return smoothPath.size();
 }
\ No newline at end of file
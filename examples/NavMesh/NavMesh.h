@@ -1,8 +1,11 @@
 #pragma once
 
 #include "Pathfinding.h"
+#include "Heuristics.h"
 #include "Behaviour.h"
 #include "Condition.h"
+#include "PathRequestQueue.h"
+#include "TimeSlicedAStar.h"
 
 // forward declaring some Poly2Tri objects
 namespace p2t {
@@ -36,6 +39,7 @@ public:
 	// treat them as NavMesh::Node's and smooth the path using a
 	// funneling algorithm from (http://digestingduck.blogspot.com.au/2010/03/simple-stupid-funnel-algorithm.html)
 	// we must build a list of portals first
+	static size_t smoothPath(const graph::Path& path, graph::BasicPath<glm::vec3>& smoothPath);
 	static size_t smoothPath(const std::list<graph::Node*>& path, std::list<glm::vec3>& smoothPath);
 
 	// access nodes
@@ -80,13 +84,12 @@ public:
 			return count;
 		}
 
-		// simple distance squared
+		// straight line distance, edges cost the distance between
+		// the centres of the triangles so this never overestimates
 		static float heuristic(graph::Node* a, graph::Node* b) {
 			NavMesh::Node* s = (NavMesh::Node*)a;
 			NavMesh::Node* e = (NavMesh::Node*)b;
-			float x = e->position.x - s->position.x;
-			float y = e->position.y - s->position.y;
-			return x * x + y * y;
+			return graph::Heuristics::euclidean(e->position.x - s->position.x, e->position.y - s->position.y);
 		}
 	};
 
@@ -101,11 +104,14 @@ public:
 		virtual ai::eBehaviourResult execute(ai::Agent* entity);
 	};
 
-	// a behaviour that finds a new path and smooths it
+	// a behaviour that finds a new path and smooths it.
+	// if given a PathRequestQueue the search runs on a worker thread
+	// and the path is smoothed when it is delivered on a later frame
 	class NewPathBehaviour : public ai::Behaviour {
 	public:
 
-		NewPathBehaviour(NavMesh* navMesh) : m_navMesh(navMesh) {}
+		NewPathBehaviour(NavMesh* navMesh, ai::PathRequestQueue* pathRequests = nullptr)
+			: m_navMesh(navMesh), m_pathRequests(pathRequests) {}
 		virtual ~NewPathBehaviour() {}
 
 		virtual ai::eBehaviourResult execute(ai::Agent* entity);
@@ -113,6 +119,32 @@ public:
 	protected:
 
 		NavMesh* m_navMesh;
+		ai::PathRequestQueue* m_pathRequests;
+
+		// search data for when there is no queue
+		graph::SearchContext m_context;
+	};
+
+	// a behaviour that finds a new path a few nodes at a time, returning
+	// RUNNING until the search completes. Each agent's search is kept in
+	// its blackboard as "search" so the behaviour itself holds no state,
+	// but a tree using it must still belong to one agent as composites
+	// remember which child is RUNNING. While searching the best partial
+	// path so far is smoothed into "smoothpath" so the agent can set off.
+	// A new search only begins once "smoothpath" is empty
+	class SlicedPathBehaviour : public ai::Behaviour {
+	public:
+
+		SlicedPathBehaviour(NavMesh* navMesh, unsigned int expansionsPerFrame = 32)
+			: m_navMesh(navMesh), m_expansionsPerFrame(expansionsPerFrame) {}
+		virtual ~SlicedPathBehaviour() {}
+
+		virtual ai::eBehaviourResult execute(ai::Agent* entity);
+
+	protected:
+
+		NavMesh* m_navMesh;
+		unsigned int m_expansionsPerFrame;
 	};
 
 protected:
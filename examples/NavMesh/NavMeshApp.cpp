@@ -4,7 +4,10 @@
 
 #include "BehaviourTree.h"
 
-NavMeshApp::NavMeshApp() {
+NavMeshApp::NavMeshApp()
+	: m_pathSearch(nullptr),
+	m_queuePaths(false),
+	m_pathRequests(1) {
 
 }
 
@@ -42,7 +45,7 @@ bool NavMeshApp::startup() {
 	while (end == start)
 		end = m_navMesh->getRandomNode();
 
-	graph::Search::aStar(start, end, m_path, NavMesh::Node::heuristic);
+	graph::Search::aStar(m_searchContext, start, end, m_path, NavMesh::Node::heuristic);
 
 	NavMesh::smoothPath(m_path, m_smoothPath);
 
@@ -51,17 +54,37 @@ bool NavMeshApp::startup() {
 	m_player.getBlackboard().set("speed", 100.0f);
 	m_player.setPosition({ start->position.x, start->position.y, 0 });
 
-//	auto selector = new SelectorBehaviour();
-//	selector->addChild(new NavMesh::FollowPathBehaviour());
-//	selector->addChild(new NavMesh::NewPathBehaviour(m_navMesh));
+	// follow the path, then search for a path to a random node once it
+	// has been followed, either a few nodes a frame or on a worker thread
+	auto selector = new ai::SelectorBehaviour();
+	auto followPath = new NavMesh::FollowPathBehaviour();
+	auto slicedPath = new NavMesh::SlicedPathBehaviour(m_navMesh);
+	auto queuedPath = new NavMesh::NewPathBehaviour(m_navMesh, &m_pathRequests);
 
-	m_player.addBehaviour(new NavMesh::FollowPathBehaviour());
+	m_pathSearch = new ai::SwitchBehaviour();
+	m_pathSearch->addChild(slicedPath);
+	m_pathSearch->addChild(queuedPath);
+	m_pathSearch->setIndex(m_queuePaths ? 1 : 0);
+
+	selector->addChild(followPath);
+	selector->addChild(m_pathSearch);
+
+	m_behaviours = { selector, followPath, m_pathSearch, slicedPath, queuedPath };
+
+	m_player.addBehaviour(selector);
 
 	return true;
 }
 
 void NavMeshApp::shutdown() {
 
+	// the workers must be done with the nav mesh before it goes
+	m_pathRequests.clear();
+
+	for (auto behaviour : m_behaviours)
+		delete behaviour;
+	m_behaviours.clear();
+
 	delete m_navMesh;
 
 	delete m_font;
@@ -69,6 +92,9 @@ void NavMeshApp::shutdown() {
 }
 
 void NavMeshApp::update() {
+
+	// hand over a path found on a worker thread
+	m_pathRequests.update();
 	
 	m_player.executeBehaviours();
 
@@ -79,6 +105,12 @@ void NavMeshApp::update() {
 	if (input->isKeyDown(app::INPUT_KEY_ESCAPE))
 		quit();
 
+	if (input->wasKeyPressed(app::INPUT_KEY_Q)) {
+		cancelPathSearch();
+		m_queuePaths = !m_queuePaths;
+		m_pathSearch->setIndex(m_queuePaths ? 1 : 0);
+	}
+
 	if (input->wasMouseButtonPressed(app::INPUT_MOUSE_BUTTON_LEFT)) {
 
 		int x = 0, y = 0;
@@ -91,13 +123,26 @@ void NavMeshApp::update() {
 		auto start = m_navMesh->findClosest(position);
 
 		if (start != end) {
-			graph::Search::aStar(start, end, m_path, NavMesh::Node::heuristic);
+
+			// stop any search towards a random node replacing this path
+			cancelPathSearch();
+
+			graph::Search::aStar(m_searchContext, start, end, m_path, NavMesh::Node::heuristic);
 
 			NavMesh::smoothPath(m_path, m_smoothPath);
 		}
 	}
 }
 
+void NavMeshApp::cancelPathSearch() {
+
+	graph::TimeSlicedAStar* search = nullptr;
+	if (m_player.getBlackboard().get("search", &search))
+		search->cancel();
+
+	m_pathRequests.cancel(&m_player);
+}
+
 void NavMeshApp::draw() {
 
 	// wipe the screen to the background colour
@@ -109,29 +154,24 @@ void NavMeshApp::draw() {
 	auto position = m_player.getPosition();
 	m_2dRenderer->drawCircle(position.x, position.y, 10);
 
-	std::list<glm::vec3> smooth;
-	NavMesh::smoothPath(m_path, smooth);
+	NavMesh::smoothPath(m_path, m_drawPath);
 
 	m_2dRenderer->setRenderColour(1, 1, 1);
-	auto prev = smooth.begin();
-	for (auto iter = smooth.begin(); iter != smooth.end(); ++iter) {
+	for (size_t i = 1; i < m_drawPath.size(); ++i) {
 
-		if (iter != smooth.begin()) {
+		auto& start = m_drawPath[i];
+		auto& end = m_drawPath[i - 1];
 
-			m_2dRenderer->drawLine(iter->x, iter->y, prev->x, prev->y, 3);
-		}
-		prev = iter;
+		m_2dRenderer->drawLine(start.x, start.y, end.x, end.y, 3);
 	}
 
 	m_2dRenderer->setRenderColour(0, 1, 1);
-	for (auto node : m_path) {
+	for (size_t i = 1; i < m_path.size(); ++i) {
 
-		auto start = (NavMesh::Node*)node;
-		auto end = (NavMesh::Node*)node->previous;
+		auto start = (NavMesh::Node*)m_path[i];
+		auto end = (NavMesh::Node*)m_path[i - 1];
 
-		if (end != nullptr) {
-			m_2dRenderer->drawLine(start->position.x, start->position.y, end->position.x, end->position.y, 3);
-		}
+		m_2dRenderer->drawLine(start->position.x, start->position.y, end->position.x, end->position.y, 3);
 	}
 
 	// draw nav mesh polygons
@@ -149,6 +189,11 @@ void NavMeshApp::draw() {
 		m_2dRenderer->drawBox(o.x + o.w * 0.5f, o.y + o.h * 0.5f, o.w, o.h);
 	}
 
+	// output some text
+	m_2dRenderer->setRenderColour(1, 1, 1);
+	m_2dRenderer->drawText(m_font, m_queuePaths ? "Press ESC to quit, Q = toggle path search (worker thread)" :
+												"Press ESC to quit, Q = toggle path search (time sliced)", 0, 0);
+
 	// done drawing sprites
 	m_2dRenderer->end();
 }
\ No newline at end of file
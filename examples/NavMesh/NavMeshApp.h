@@ -5,6 +5,7 @@
 
 #include "NavMesh.h"
 #include "Agent.h"
+#include "BehaviourTree.h"
 
 class NavMeshApp : public app::Application {
 public:
@@ -20,6 +21,9 @@ public:
 
 protected:
 
+	// stops the player's search for a random path, if it has one
+	void cancelPathSearch();
+
 	app::Renderer2D*	m_2dRenderer;
 	app::Font*			m_font;
 
@@ -27,6 +31,21 @@ protected:
 
 	ai::Agent m_player;
 
-	std::list<graph::Node*> m_path;
-	std::list<glm::vec3> m_smoothPath;
+	// the player's behaviour tree, deleted on shutdown
+	std::vector<ai::Behaviour*> m_behaviours;
+
+	// picks between searching a few nodes a frame
+	// and searching on a worker thread
+	ai::SwitchBehaviour* m_pathSearch;
+	bool m_queuePaths;
+
+	ai::PathRequestQueue m_pathRequests;
+
+	graph::SearchContext m_searchContext;
+
+	graph::Path m_path;
+	graph::BasicPath<glm::vec3> m_smoothPath;
+
+	// the whole smoothed path for drawing, kept to reuse its memory
+	graph::BasicPath<glm::vec3> m_drawPath;
 };
\ No newline at end of file
@@ -68,7 +68,7 @@ bool PathfindingApp::startup() {
 
 			if (sqrDist <= (30*30)) {
 				graph::Edge* edge = new graph::Edge();
-				edge->cost = sqrDist;
+				edge->cost = sqrt(sqrDist);
 				edge->target = b;
 
 				a->edges.push_back(edge);
@@ -88,7 +88,7 @@ bool PathfindingApp::startup() {
 	graph::Search::aStar(start,
 							   m_nodes[rand() % m_nodes.size()],
 							   m_path,
-							   MyNode::heuristicDistanceSqr);
+							   MyNode::heuristicOctile);
 
 	/*Pathfinding::Search::dijkstra(start,
 							   m_nodes[rand() % m_nodes.size()],
@@ -299,7 +299,7 @@ ai::eBehaviourResult NewPathBehaviour::execute(ai::Agent* entity) {
 		auto first = findClosest(position.x, position.y, m_nodes);
 		auto end = m_nodes[rand() % m_nodes.size()];
 
-		found = graph::Search::aStar(first, end, *path, MyNode::heuristicDistanceSqr);
+		found = graph::Search::aStar(first, end, *path, MyNode::heuristicOctile);
 
 	} while (found == false);
 
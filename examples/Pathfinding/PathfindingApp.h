@@ -4,6 +4,7 @@
 #include "Renderer2D.h"
 #include "Texture.h"
 #include "Pathfinding.h"
+#include "Heuristics.h"
 #include "Behaviour.h"
 #include "Agent.h"
 #include "Condition.h"
@@ -15,34 +16,31 @@ public:
 	MyNode() {}
 	virtual ~MyNode() {}
 
+	// edges cost their length, so these never overestimate.
+	// Squared distances would, making A* return poor paths
 	static float heuristicManhattan(Node* a, Node* b) {
 
 		MyNode* s = (MyNode*)a;
 		MyNode* e = (MyNode*)b;
 
-		return (e->x - s->x) + (e->y - s->y);
+		return graph::Heuristics::manhattan(e->x - s->x, e->y - s->y);
 	}
 
-	static float heuristicDistanceSqr(Node* a, Node* b) {
+	static float heuristicDistance(Node* a, Node* b) {
 
 		MyNode* s = (MyNode*)a;
 		MyNode* e = (MyNode*)b;
 
-		float x = e->x - s->x;
-		float y = e->y - s->y;
-
-		return x * x + y * y;
+		return graph::Heuristics::euclidean(e->x - s->x, e->y - s->y);
 	}
 
-	static float heuristicDistance(Node* a, Node* b) {
+	// exact on an open 8-connected grid
+	static float heuristicOctile(Node* a, Node* b) {
 
 		MyNode* s = (MyNode*)a;
 		MyNode* e = (MyNode*)b;
 
-		float x = e->x - s->x;
-		float y = e->y - s->y;
-
-		return sqrt(x * x + y * y);
+		return graph::Heuristics::octile(e->x - s->x, e->y - s->y);
 	}
 	
 	float x, y;
@@ -0,0 +1,372 @@
+#include "BenchMaps.h"
+#include "Heuristics.h"
+#include "NavMesh.h"
+
+#include <stb_image.h>
+
+#include <random>
+#include <cmath>
+#include <algorithm>
+
+BenchMap::~BenchMap() {
+	destroy();
+}
+
+void BenchMap::destroy() {
+
+	// navmesh nodes belong to the NavMesh
+	if (m_navMesh != nullptr) {
+		delete m_navMesh;
+		m_navMesh = nullptr;
+	}
+	else {
+		for (auto node : m_nodes)
+			delete node;
+	}
+
+	m_nodes.clear();
+	m_positions.clear();
+	m_cellNodes.clear();
+	m_grid.create(0, 0);
+}
+
+bool BenchMap::createGrid(int size, unsigned int seed) {
+
+	destroy();
+
+	if (size < 2)
+		return false;
+
+	m_name = "grid";
+
+	std::mt19937 random(seed);
+	std::uniform_int_distribution<int> position(0, size - 1);
+	std::uniform_int_distribution<int> extent(1, std::max(1, size / 8));
+
+	// drop random rectangles until about a quarter of the cells are blocked
+	m_grid.create(size, size, true);
+
+	int blocked = 0;
+	while (blocked < size * size / 4) {
+
+		int x = position(random);
+		int y = position(random);
+		int w = extent(random);
+		int h = extent(random);
+
+		for (int cy = y; cy < std::min(y + h, size); ++cy) {
+			for (int cx = x; cx < std::min(x + w, size); ++cx) {
+				if (m_grid.isWalkable(cx, cy)) {
+					m_grid.setWalkable(cx, cy, false);
+					++blocked;
+				}
+			}
+		}
+	}
+
+	buildGridGraph();
+	finish(seed);
+
+	return m_nodes.size() > 1;
+}
+
+bool BenchMap::createMaze(int size, unsigned int seed) {
+
+	destroy();
+
+	// passages are on odd cells with walls between them
+	if ((size & 1) == 0)
+		++size;
+	if (size < 3)
+		return false;
+
+	m_name = "maze";
+
+	std::mt19937 random(seed);
+
+	m_grid.create(size, size, false);
+
+	// recursive backtracker, kept on an explicit stack
+	std::vector<std::pair<int, int>> stack;
+	stack.push_back({ 1, 1 });
+	m_grid.setWalkable(1, 1, true);
+
+	const int offsets[4][2] = { { 2, 0 }, { -2, 0 }, { 0, 2 }, { 0, -2 } };
+
+	while (stack.empty() == false) {
+
+		int x = stack.back().first;
+		int y = stack.back().second;
+
+		// the unvisited cells two steps away
+		int options[4];
+		int count = 0;
+		for (int i = 0; i < 4; ++i) {
+			int nx = x + offsets[i][0];
+			int ny = y + offsets[i][1];
+			if (nx > 0 && ny > 0 && nx < size - 1 && ny < size - 1 &&
+				m_grid.isWalkable(nx, ny) == false)
+				options[count++] = i;
+		}
+
+		if (count == 0) {
+			stack.pop_back();
+			continue;
+		}
+
+		int i = options[std::uniform_int_distribution<int>(0, count - 1)(random)];
+		int nx = x + offsets[i][0];
+		int ny = y + offsets[i][1];
+
+		m_grid.setWalkable(x + offsets[i][0] / 2, y + offsets[i][1] / 2, true);
+		m_grid.setWalkable(nx, ny, true);
+		stack.push_back({ nx, ny });
+	}
+
+	// a perfect maze only has one route, so knock out some of the walls
+	// between passages to give the searches a choice
+	std::uniform_int_distribution<int> position(1, size - 2);
+	for (int i = 0; i < size * size / 50; ++i) {
+
+		int x = position(random);
+		int y = position(random);
+
+		if (m_grid.isWalkable(x, y) == false &&
+			((m_grid.isWalkable(x - 1, y) && m_grid.isWalkable(x + 1, y)) ||
+			 (m_grid.isWalkable(x, y - 1) && m_grid.isWalkable(x, y + 1))))
+			m_grid.setWalkable(x, y, true);
+	}
+
+	buildGridGraph();
+	finish(seed);
+
+	return m_nodes.size() > 1;
+}
+
+bool BenchMap::createGeometric(int size, unsigned int seed) {
+
+	destroy();
+
+	if (size < 2)
+		return false;
+
+	m_name = "geometric";
+
+	std::mt19937 random(seed);
+	std::uniform_real_distribution<float> position(0, (float)size);
+
+	// size * size points over a size by size square, so a radius of
+	// 1.5 gives each point about 7 neighbours
+	const float radius = 1.5f;
+	int count = size * size;
+
+	std::vector<BenchNode*> nodes;
+	for (int i = 0; i < count; ++i) {
+		float x = position(random);
+		float y = position(random);
+		nodes.push_back(new BenchNode(x, y));
+	}
+
+	// bucket the points by radius sized cells so only neighbouring
+	// buckets need checking
+	int buckets = std::max(1, (int)(size / radius));
+	float bucketSize = size / (float)buckets;
+
+	auto bucketOf = [&](float v) {
+		return std::min(buckets - 1, (int)(v / bucketSize));
+	};
+
+	std::vector<std::vector<BenchNode*>> grid(buckets * buckets);
+	for (auto node : nodes)
+		grid[bucketOf(node->y) * buckets + bucketOf(node->x)].push_back(node);
+
+	for (auto a : nodes) {
+
+		int bx = bucketOf(a->x);
+		int by = bucketOf(a->y);
+
+		for (int y = std::max(0, by - 1); y <= std::min(buckets - 1, by + 1); ++y) {
+			for (int x = std::max(0, bx - 1); x <= std::min(buckets - 1, bx + 1); ++x) {
+				for (auto b : grid[y * buckets + x]) {
+					if (a == b) continue;
+
+					float dist = graph::Heuristics::euclidean(b->x - a->x, b->y - a->y);
+					if (dist <= radius)
+						a->edges.push_back(new graph::Edge(b, dist));
+				}
+			}
+		}
+	}
+
+	m_nodes.assign(nodes.begin(), nodes.end());
+	finish(seed);
+
+	return m_nodes.size() > 1;
+}
+
+bool BenchMap::createNavMesh(int size, unsigned int seed) {
+
+	destroy();
+
+	if (size < 2)
+		return false;
+
+	m_name = "navmesh";
+
+	std::mt19937 random(seed);
+
+	// square obstacles as in the NavMesh example, 60 units across with
+	// 10 units of padding, in an area that grows with size
+	const float obstacleSize = 60;
+	const float padding = 10;
+	float area = size * 20.0f;
+
+	std::uniform_real_distribution<float> position(padding * 2, area - obstacleSize - padding * 2);
+
+	m_navMesh = new NavMesh(area, area);
+
+	// roughly a tenth of the area covered, giving up on
+	// obstacles that can't find a space
+	int obstacles = (int)(area * area * 0.1f / (obstacleSize * obstacleSize));
+	for (int i = 0; i < obstacles; ++i) {
+		for (int attempt = 0; attempt < 20; ++attempt) {
+			if (m_navMesh->addObstacle(position(random), position(random), obstacleSize, obstacleSize, padding))
+				break;
+		}
+	}
+
+	m_navMesh->build();
+
+	m_nodes.assign(m_navMesh->getNodes().begin(), m_navMesh->getNodes().end());
+	finish(seed);
+
+	return m_nodes.size() > 1;
+}
+
+bool BenchMap::createImage(const char* filename) {
+
+	destroy();
+
+	int width = 0, height = 0, channels = 0;
+	unsigned char* pixels = stbi_load(filename, &width, &height, &channels, 1);
+	if (pixels == nullptr)
+		return false;
+
+	m_name = "image";
+
+	m_grid.create(width, height, [&](int x, int y) {
+		return pixels[y * width + x] != 0;
+	});
+
+	stbi_image_free(pixels);
+
+	buildGridGraph();
+	finish(0);
+
+	return m_nodes.size() > 1;
+}
+
+void BenchMap::buildGridGraph() {
+
+	int width = m_grid.getWidth();
+	int height = m_grid.getHeight();
+
+	m_cellNodes.assign(m_grid.getCellCount(), nullptr);
+
+	for (int y = 0; y < height; ++y) {
+		for (int x = 0; x < width; ++x) {
+			if (m_grid.isWalkable(x, y)) {
+				BenchNode* node = new BenchNode((float)x, (float)y);
+				m_cellNodes[m_grid.getIndex(x, y)] = node;
+				m_nodes.push_back(node);
+			}
+		}
+	}
+
+	// 8-connected without cutting corners, the same moves as
+	// jumpPointSearch and HierarchicalGrid make
+	for (int y = 0; y < height; ++y) {
+		for (int x = 0; x < width; ++x) {
+
+			graph::Node* node = m_cellNodes[m_grid.getIndex(x, y)];
+			if (node == nullptr)
+				continue;
+
+			for (int dy = -1; dy <= 1; ++dy) {
+				for (int dx = -1; dx <= 1; ++dx) {
+
+					if ((dx == 0 && dy == 0) ||
+						m_grid.isWalkable(x + dx, y + dy) == false)
+						continue;
+
+					if (dx != 0 && dy != 0 &&
+						(m_grid.isWalkable(x + dx, y) == false ||
+						 m_grid.isWalkable(x, y + dy) == false))
+						continue;
+
+					float cost = (dx != 0 && dy != 0) ? 1.41421356f : 1.0f;
+					node->edges.push_back(new graph::Edge(m_cellNodes[m_grid.getIndex(x + dx, y + dy)], cost));
+				}
+			}
+		}
+	}
+}
+
+void BenchMap::finish(unsigned int seed) {
+
+	m_positions.assign(graph::Node::getIDCount() * 2, 0);
+
+	for (auto node : m_nodes) {
+
+		float x = 0, y = 0;
+		if (m_navMesh != nullptr) {
+			x = ((NavMesh::Node*)node)->position.x;
+			y = ((NavMesh::Node*)node)->position.y;
+		}
+		else {
+			x = ((BenchNode*)node)->x;
+			y = ((BenchNode*)node)->y;
+		}
+
+		m_positions[node->getID() * 2 + 0] = x;
+		m_positions[node->getID() * 2 + 1] = y;
+	}
+
+	if (m_nodes.empty())
+		return;
+
+	// about 1 in 100 nodes are goals for dijkstraFindFlags
+	std::mt19937 random(seed + 1);
+	std::uniform_int_distribution<size_t> index(0, m_nodes.size() - 1);
+
+	for (size_t i = 0; i < m_nodes.size() / 100 + 1; ++i)
+		m_nodes[index(random)]->flags |= GOAL_FLAG;
+}
+
+float BenchMap::heuristic(graph::Node* a, graph::Node* b) const {
+
+	float dx = getX(b) - getX(a);
+	float dy = getY(b) - getY(a);
+
+	if (isGrid())
+		return graph::Heuristics::octile(dx, dy);
+
+	return graph::Heuristics::euclidean(dx, dy);
+}
+
+void BenchMap::createQueries(unsigned int count, unsigned int seed, std::vector<std::pair<unsigned int, unsigned int>>& queries) const {
+
+	queries.clear();
+
+	if (m_nodes.empty())
+		return;
+
+	std::mt19937 random(seed);
+	std::uniform_int_distribution<unsigned int> index(0, (unsigned int)m_nodes.size() - 1);
+
+	for (unsigned int i = 0; i < count; ++i) {
+		unsigned int start = index(random);
+		unsigned int end = index(random);
+		queries.push_back({ start, end });
+	}
+}
\ No newline at end of file
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "Pathfinding.h"
+#include "Grid.h"
+
+#include <string>
+#include <vector>
+
+class NavMesh;
+
+// a node of a generated map
+class BenchNode : public graph::Node {
+public:
+
+	BenchNode(float x, float y) : x(x), y(y) {}
+	virtual ~BenchNode() {}
+
+	float x, y;
+};
+
+// a graph to benchmark the searches on. Every map is built from a seed
+// so the same seed and size always give the same graph and queries
+class BenchMap {
+public:
+
+	BenchMap() : m_navMesh(nullptr) {}
+	~BenchMap();
+
+	// owns the nodes so can't be copied
+	BenchMap(const BenchMap&) = delete;
+	BenchMap& operator = (const BenchMap&) = delete;
+
+	enum {
+		// node flag searched for by dijkstraFindFlags
+		GOAL_FLAG = (1 << 0),
+	};
+
+	// an 8-connected grid with rectangular obstacles covering about a quarter of it
+	bool createGrid(int size, unsigned int seed);
+
+	// an 8-connected grid carved into a maze, with a few extra
+	// walls knocked out so there is more than one route
+	bool createMaze(int size, unsigned int seed);
+
+	// points scattered over a square, each linked to those within a radius
+	bool createGeometric(int size, unsigned int seed);
+
+	// a NavMesh triangulated around square obstacles
+	bool createNavMesh(int size, unsigned int seed);
+
+	// an 8-connected grid from an image, with black pixels unwalkable
+	bool createImage(const char* filename);
+
+	const std::string& getName() const { return m_name; }
+
+	const std::vector<graph::Node*>& getNodes() const { return m_nodes; }
+
+	// the position of a node by ID
+	float getX(graph::Node* node) const { return m_positions[node->getID() * 2 + 0]; }
+	float getY(graph::Node* node) const { return m_positions[node->getID() * 2 + 1]; }
+
+	// grid maps can also be searched by the grid only searches, with
+	// positions in cells and cellNodes holding each cell's node
+	bool isGrid() const { return m_grid.getCellCount() > 0; }
+	const graph::Grid& getGrid() const { return m_grid; }
+	const std::vector<graph::Node*>& getCellNodes() const { return m_cellNodes; }
+
+	// straight line distance for general maps, octile distance for grids
+	float heuristic(graph::Node* a, graph::Node* b) const;
+
+	// pairs of node indices, the same for a given seed
+	void createQueries(unsigned int count, unsigned int seed, std::vector<std::pair<unsigned int, unsigned int>>& queries) const;
+
+protected:
+
+	void destroy();
+
+	// makes the nodes and edges once m_grid is filled in
+	void buildGridGraph();
+
+	// records node positions by ID and flags some nodes as goals
+	void finish(unsigned int seed);
+
+	std::string					m_name;
+	std::vector<graph::Node*>	m_nodes;
+	std::vector<float>			m_positions;
+
+	graph::Grid					m_grid;
+	std::vector<graph::Node*>	m_cellNodes;
+
+	// owns the nodes of navmesh maps
+	NavMesh*					m_navMesh;
+};
\ No newline at end of file
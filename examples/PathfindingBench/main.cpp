@@ -0,0 +1,655 @@
+#include "BenchMaps.h"
+#include "Pathfinding.h"
+#include "CsrGraph.h"
+#include "Heuristics.h"
+#include "HierarchicalGrid.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+// a headless benchmark of the searches over seeded synthetic maps.
+// Every engine runs the same queries on each map and reports latency
+// percentiles, nodes expanded, heap allocations and peak heap use as
+// CSV or JSON, for example:
+//   PathfindingBench --size 256 --queries 500 --maps grid,maze --format json --out results.json
+
+// counts every heap allocation so that the searches' memory use can be
+// reported. Each block carries its size in a header so that deletes can
+// be subtracted. The benchmark is single threaded
+namespace {
+
+const size_t ALLOCATION_HEADER = 16;
+
+size_t g_allocationCount = 0;
+size_t g_allocatedBytes = 0;
+size_t g_peakBytes = 0;
+
+void* allocate(size_t size) {
+	char* block = (char*)std::malloc(size + ALLOCATION_HEADER);
+	if (block == nullptr)
+		return nullptr;
+
+	*(size_t*)block = size;
+
+	++g_allocationCount;
+	g_allocatedBytes += size;
+	g_peakBytes = std::max(g_peakBytes, g_allocatedBytes);
+
+	return block + ALLOCATION_HEADER;
+}
+
+void release(void* p) {
+	if (p == nullptr)
+		return;
+
+	char* block = (char*)p - ALLOCATION_HEADER;
+	g_allocatedBytes -= *(size_t*)block;
+	std::free(block);
+}
+
+} // namespace
+
+void* operator new(size_t size) {
+	void* p = allocate(size);
+	if (p == nullptr)
+		throw std::bad_alloc();
+	return p;
+}
+
+void* operator new[](size_t size) {
+	void* p = allocate(size);
+	if (p == nullptr)
+		throw std::bad_alloc();
+	return p;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+
+void operator delete(void* p) noexcept { release(p); }
+void operator delete[](void* p) noexcept { release(p); }
+void operator delete(void* p, size_t) noexcept { release(p); }
+void operator delete[](void* p, size_t) noexcept { release(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { release(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { release(p); }
+
+// a query between two indices into the map's nodes, which are also
+// the CsrGraph indices as the graph is built from the same vector
+struct Query {
+	unsigned int start, end;
+};
+
+// the sum of the edge costs along a path of nodes
+template <typename Iterator>
+static float getPathCost(Iterator begin, Iterator end) {
+
+	float cost = 0;
+	if (begin == end)
+		return cost;
+
+	for (Iterator previous = begin++; begin != end; previous = begin++) {
+		for (auto edge : (*previous)->edges) {
+			if (edge->target == *begin) {
+				cost += edge->cost;
+				break;
+			}
+		}
+	}
+	return cost;
+}
+
+// a search to benchmark. setup() does any preprocessing the engine needs,
+// and is measured separately from the queries
+class Engine {
+public:
+
+	Engine(const char* name, bool optimal = true) : m_name(name), m_optimal(optimal), m_map(nullptr) {}
+	virtual ~Engine() {}
+
+	const char* getName() const { return m_name; }
+
+	// optimal engines should find paths costing the same as dijkstra's
+	bool isOptimal() const { return m_optimal; }
+
+	virtual bool canRun(const BenchMap& map) const { return true; }
+
+	virtual void setup(const BenchMap& map) { m_map = &map; }
+
+	virtual bool search(const Query& query) = 0;
+
+	// the cost of the most recent path found
+	virtual float getCost() const = 0;
+
+	// false if the context's count doesn't cover the whole search
+	virtual bool countsExpanded() const { return true; }
+
+	unsigned int getExpandedCount() const { return m_context.getExpandedCount(); }
+
+protected:
+
+	graph::Node* getNode(unsigned int index) const { return m_map->getNodes()[index]; }
+
+	const char*				m_name;
+	bool					m_optimal;
+
+	const BenchMap*			m_map;
+	graph::SearchContext	m_context;
+};
+
+// engines searching the Node graph into a Path
+class NodeEngine : public Engine {
+public:
+
+	NodeEngine(const char* name, bool optimal = true) : Engine(name, optimal) {}
+	virtual ~NodeEngine() {}
+
+	virtual float getCost() const { return getPathCost(m_path.begin(), m_path.end()); }
+
+protected:
+
+	graph::Path	m_path;
+};
+
+class DijkstraEngine : public NodeEngine {
+public:
+
+	DijkstraEngine() : NodeEngine("dijkstra") {}
+
+	virtual bool search(const Query& query) {
+		return graph::Search::dijkstra(m_context, getNode(query.start), getNode(query.end), m_path);
+	}
+};
+
+// searches from the query's start to the closest goal node instead of its end
+class DijkstraFindFlagsEngine : public Engine {
+public:
+
+	DijkstraFindFlagsEngine() : Engine("dijkstraFindFlags", false) {}
+
+	virtual bool search(const Query& query) {
+		return graph::Search::dijkstraFindFlags(m_context, getNode(query.start), BenchMap::GOAL_FLAG, m_path);
+	}
+
+	virtual float getCost() const { return getPathCost(m_path.begin(), m_path.end()); }
+
+protected:
+
+	std::list<graph::Node*>	m_path;
+};
+
+// A* calling the heuristic through a HeuristicCheck
+class AStarEngine : public NodeEngine {
+public:
+
+	AStarEngine() : NodeEngine("aStar") {}
+
+	virtual void setup(const BenchMap& map) {
+		NodeEngine::setup(map);
+		m_heuristic = [&map](graph::Node* a, graph::Node* b) { return map.heuristic(a, b); };
+	}
+
+	virtual bool search(const Query& query) {
+		return graph::Search::aStar(m_context, getNode(query.start), getNode(query.end), m_path, m_heuristic);
+	}
+
+protected:
+
+	graph::Search::HeuristicCheck	m_heuristic;
+};
+
+// the templated A* with the heuristic inlined
+class AStarInlineEngine : public NodeEngine {
+public:
+
+	AStarInlineEngine() : NodeEngine("aStar inlined") {}
+
+	virtual bool search(const Query& query) {
+		const BenchMap* map = m_map;
+		return graph::Search::aStar(m_context, getNode(query.start), getNode(query.end), m_path,
+									[map](graph::Node* a, graph::Node* b) { return map->heuristic(a, b); });
+	}
+};
+
+// engines searching a CsrGraph copy of the map by index
+class CsrEngine : public Engine {
+public:
+
+	CsrEngine(const char* name, bool optimal = true) : Engine(name, optimal) {}
+	virtual ~CsrEngine() {}
+
+	virtual void setup(const BenchMap& map) {
+		Engine::setup(map);
+		m_graph.build(map.getNodes());
+		m_heuristic = [&map](unsigned int a, unsigned int b) {
+			return map.heuristic(map.getNodes()[a], map.getNodes()[b]);
+		};
+	}
+
+	virtual float getCost() const {
+
+		float cost = 0;
+		for (size_t i = 1; i < m_path.size(); ++i) {
+			for (auto edge = m_graph.edgesBegin(m_path[i - 1]); edge != m_graph.edgesEnd(m_path[i - 1]); ++edge) {
+				if (edge->target == m_path[i]) {
+					cost += edge->cost;
+					break;
+				}
+			}
+		}
+		return cost;
+	}
+
+protected:
+
+	graph::CsrGraph						m_graph;
+	graph::Search::IndexHeuristicCheck	m_heuristic;
+	std::vector<unsigned int>			m_path;
+};
+
+class CsrDijkstraEngine : public CsrEngine {
+public:
+
+	CsrDijkstraEngine() : CsrEngine("csr dijkstra") {}
+
+	virtual bool search(const Query& query) {
+		return graph::Search::dijkstra(m_graph, m_context, query.start, query.end, m_path);
+	}
+};
+
+class CsrAStarEngine : public CsrEngine {
+public:
+
+	CsrAStarEngine() : CsrEngine("csr aStar") {}
+
+	virtual bool search(const Query& query) {
+		return graph::Search::aStar(m_graph, m_context, query.start, query.end, m_path, m_heuristic);
+	}
+};
+
+class BidirectionalEngine : public CsrEngine {
+public:
+
+	BidirectionalEngine() : CsrEngine("bidirectionalAStar") {}
+
+	virtual bool search(const Query& query) {
+		return graph::Search::bidirectionalAStar(m_graph, m_context, query.start, query.end, m_path, m_heuristic);
+	}
+};
+
+// A* or bidirectional A* with the landmark heuristic
+class LandmarkEngine : public CsrEngine {
+public:
+
+	LandmarkEngine(bool bidirectional)
+		: CsrEngine(bidirectional ? "bidirectional ALT" : "aStar ALT"),
+		m_bidirectional(bidirectional) {}
+
+	virtual void setup(const BenchMap& map) {
+		CsrEngine::setup(map);
+		m_landmarks.build(m_graph, 8);
+		m_heuristic = m_landmarks.getIndexHeuristic();
+	}
+
+	virtual bool search(const Query& query) {
+		if (m_bidirectional)
+			return graph::Search::bidirectionalAStar(m_graph, m_context, query.start, query.end, m_path, m_heuristic);
+		return graph::Search::aStar(m_graph, m_context, query.start, query.end, m_path, m_heuristic);
+	}
+
+protected:
+
+	bool						m_bidirectional;
+	graph::LandmarkHeuristic	m_landmarks;
+};
+
+class JumpPointEngine : public NodeEngine {
+public:
+
+	JumpPointEngine() : NodeEngine("jumpPointSearch") {}
+
+	virtual bool canRun(const BenchMap& map) const { return map.isGrid(); }
+
+	virtual bool search(const Query& query) {
+		graph::Node* start = getNode(query.start);
+		graph::Node* end = getNode(query.end);
+		return graph::Search::jumpPointSearch(m_map->getGrid(), m_context,
+											  (int)m_map->getX(start), (int)m_map->getY(start),
+											  (int)m_map->getX(end), (int)m_map->getY(end),
+											  m_map->getCellNodes(), m_path);
+	}
+};
+
+// HPA* paths are near optimal, and each query runs several searches
+class HierarchicalEngine : public NodeEngine {
+public:
+
+	HierarchicalEngine() : NodeEngine("HierarchicalGrid", false) {}
+
+	virtual bool canRun(const BenchMap& map) const { return map.isGrid(); }
+
+	virtual void setup(const BenchMap& map) {
+		NodeEngine::setup(map);
+		m_hierarchy.build(map.getGrid(), m_context);
+	}
+
+	virtual bool search(const Query& query) {
+		graph::Node* start = getNode(query.start);
+		graph::Node* end = getNode(query.end);
+		return m_hierarchy.findPath(m_context,
+									(int)m_map->getX(start), (int)m_map->getY(start),
+									(int)m_map->getX(end), (int)m_map->getY(end),
+									m_map->getCellNodes(), m_path);
+	}
+
+	virtual bool countsExpanded() const { return false; }
+
+protected:
+
+	graph::HierarchicalGrid	m_hierarchy;
+};
+
+struct Result {
+	std::string map;
+	unsigned int nodes;
+	unsigned int edges;
+	std::string engine;
+	unsigned int queries;
+	unsigned int found;
+	double setupMilliseconds;
+	double p50Microseconds;
+	double p99Microseconds;
+	double meanMicroseconds;
+	double expanded;		// mean per query, negative if not counted
+	double allocations;		// mean per query
+	size_t peakBytes;		// heap in use above the start, during setup and queries
+	float cost;				// total of the paths found
+
+	// only optimal engines are checked against dijkstra
+	bool checked;
+	bool matchesDijkstra;
+};
+
+// nearest rank percentile of sorted values
+static double percentile(const std::vector<double>& sorted, double p) {
+	if (sorted.empty())
+		return 0;
+	size_t rank = (size_t)std::ceil(p * sorted.size());
+	return sorted[std::max<size_t>(rank, 1) - 1];
+}
+
+static Result run(const BenchMap& map, Engine& engine, const std::vector<Query>& queries) {
+
+	Result result;
+	result.map = map.getName();
+	result.nodes = (unsigned int)map.getNodes().size();
+	result.edges = 0;
+	for (auto node : map.getNodes())
+		result.edges += (unsigned int)node->edges.size();
+	result.engine = engine.getName();
+	result.queries = (unsigned int)queries.size();
+	result.found = 0;
+	result.expanded = engine.countsExpanded() ? 0 : -1;
+	result.cost = 0;
+	result.checked = false;
+	result.matchesDijkstra = false;
+
+	std::vector<double> latencies;
+	latencies.reserve(queries.size());
+
+	// measure from here so only the engine's own memory counts
+	size_t baseBytes = g_allocatedBytes;
+	g_peakBytes = g_allocatedBytes;
+
+	auto begin = std::chrono::high_resolution_clock::now();
+	engine.setup(map);
+	auto end = std::chrono::high_resolution_clock::now();
+	result.setupMilliseconds = std::chrono::duration<double, std::milli>(end - begin).count();
+
+	size_t allocations = g_allocationCount;
+
+	for (auto& query : queries) {
+
+		begin = std::chrono::high_resolution_clock::now();
+		bool found = engine.search(query);
+		end = std::chrono::high_resolution_clock::now();
+
+		latencies.push_back(std::chrono::duration<double, std::micro>(end - begin).count());
+
+		if (engine.countsExpanded())
+			result.expanded += engine.getExpandedCount();
+
+		// outside of the timing as it allocates for some engines
+		if (found) {
+			++result.found;
+			result.cost += engine.getCost();
+		}
+	}
+
+	result.allocations = double(g_allocationCount - allocations);
+	result.peakBytes = g_peakBytes - baseBytes;
+
+	double total = 0;
+	for (auto latency : latencies)
+		total += latency;
+
+	std::sort(latencies.begin(), latencies.end());
+	result.p50Microseconds = percentile(latencies, 0.5);
+	result.p99Microseconds = percentile(latencies, 0.99);
+
+	if (queries.empty() == false) {
+		result.meanMicroseconds = total / queries.size();
+		result.allocations /= queries.size();
+		if (result.expanded > 0)
+			result.expanded /= queries.size();
+	}
+	else
+		result.meanMicroseconds = 0;
+
+	return result;
+}
+
+static void writeCsv(FILE* file, const std::vector<Result>& results) {
+
+	fprintf(file, "map,nodes,edges,engine,queries,found,setup_ms,p50_us,p99_us,mean_us,expanded,allocations,peak_bytes,total_cost,matches_dijkstra\n");
+
+	for (auto& r : results) {
+		fprintf(file, "%s,%u,%u,%s,%u,%u,%.3f,%.3f,%.3f,%.3f,", r.map.c_str(), r.nodes, r.edges, r.engine.c_str(),
+				r.queries, r.found, r.setupMilliseconds, r.p50Microseconds, r.p99Microseconds, r.meanMicroseconds);
+		if (r.expanded >= 0)
+			fprintf(file, "%.1f", r.expanded);
+		fprintf(file, ",%.2f,%zu,%.2f,", r.allocations, r.peakBytes, r.cost);
+		if (r.checked)
+			fprintf(file, "%s", r.matchesDijkstra ? "true" : "false");
+		fprintf(file, "\n");
+	}
+}
+
+static void writeJson(FILE* file, const std::vector<Result>& results) {
+
+	fprintf(file, "[\n");
+
+	for (size_t i = 0; i < results.size(); ++i) {
+		auto& r = results[i];
+		fprintf(file, "  { \"map\": \"%s\", \"nodes\": %u, \"edges\": %u, \"engine\": \"%s\", \"queries\": %u, \"found\": %u, ",
+				r.map.c_str(), r.nodes, r.edges, r.engine.c_str(), r.queries, r.found);
+		fprintf(file, "\"setup_ms\": %.3f, \"p50_us\": %.3f, \"p99_us\": %.3f, \"mean_us\": %.3f, ",
+				r.setupMilliseconds, r.p50Microseconds, r.p99Microseconds, r.meanMicroseconds);
+		if (r.expanded >= 0)
+			fprintf(file, "\"expanded\": %.1f, ", r.expanded);
+		else
+			fprintf(file, "\"expanded\": null, ");
+		fprintf(file, "\"allocations\": %.2f, \"peak_bytes\": %zu, \"total_cost\": %.2f, \"matches_dijkstra\": %s }%s\n",
+				r.allocations, r.peakBytes, r.cost, r.checked ? (r.matchesDijkstra ? "true" : "false") : "null",
+				i + 1 < results.size() ? "," : "");
+	}
+
+	fprintf(file, "]\n");
+}
+
+static void printUsage() {
+	fprintf(stderr,
+			"usage: PathfindingBench [options]\n"
+			"  --size N        cells per side of the generated maps (default 128)\n"
+			"  --seed S        seed for the maps and queries (default 1)\n"
+			"  --queries Q     queries per map (default 200)\n"
+			"  --maps LIST     comma separated from grid,maze,geometric,navmesh,image\n"
+			"                  (default all)\n"
+			"  --image FILE    image for the image map (default ../../bin/map/map1.png)\n"
+			"  --format F      csv or json (default csv)\n"
+			"  --out FILE      write results to a file rather than stdout\n");
+}
+
+int main(int argc, char* argv[]) {
+
+	int size = 128;
+	unsigned int seed = 1;
+	unsigned int queryCount = 200;
+	std::string maps = "grid,maze,geometric,navmesh,image";
+	const char* image = "../../bin/map/map1.png";
+	std::string format = "csv";
+	const char* out = nullptr;
+
+	for (int i = 1; i < argc; ++i) {
+
+		bool hasValue = i + 1 < argc;
+
+		if (strcmp(argv[i], "--size") == 0 && hasValue)
+			size = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--seed") == 0 && hasValue)
+			seed = (unsigned int)strtoul(argv[++i], nullptr, 10);
+		else if (strcmp(argv[i], "--queries") == 0 && hasValue)
+			queryCount = (unsigned int)strtoul(argv[++i], nullptr, 10);
+		else if (strcmp(argv[i], "--maps") == 0 && hasValue)
+			maps = argv[++i];
+		else if (strcmp(argv[i], "--image") == 0 && hasValue)
+			image = argv[++i];
+		else if (strcmp(argv[i], "--format") == 0 && hasValue)
+			format = argv[++i];
+		else if (strcmp(argv[i], "--out") == 0 && hasValue)
+			out = argv[++i];
+		else {
+			printUsage();
+			return 1;
+		}
+	}
+
+	if (format != "csv" &&
+		format != "json") {
+		printUsage();
+		return 1;
+	}
+
+	FILE* file = stdout;
+	if (out != nullptr) {
+		file = fopen(out, "w");
+		if (file == nullptr) {
+			fprintf(stderr, "failed to open %s\n", out);
+			return 1;
+		}
+	}
+
+	std::vector<Result> results;
+
+	// one map at a time so that only one is in memory
+	size_t start = 0;
+	while (start <= maps.size()) {
+
+		size_t comma = maps.find(',', start);
+		if (comma == std::string::npos)
+			comma = maps.size();
+
+		std::string name = maps.substr(start, comma - start);
+		start = comma + 1;
+
+		if (name.empty())
+			continue;
+
+		BenchMap map;
+		bool created = false;
+
+		if (name == "grid")
+			created = map.createGrid(size, seed);
+		else if (name == "maze")
+			created = map.createMaze(size, seed);
+		else if (name == "geometric")
+			created = map.createGeometric(size, seed);
+		else if (name == "navmesh")
+			created = map.createNavMesh(size, seed);
+		else if (name == "image")
+			created = map.createImage(image);
+		else {
+			fprintf(stderr, "unknown map %s\n", name.c_str());
+			printUsage();
+			return 1;
+		}
+
+		if (created == false) {
+			fprintf(stderr, "skipping %s, no map could be made\n", name.c_str());
+			continue;
+		}
+
+		std::vector<std::pair<unsigned int, unsigned int>> pairs;
+		map.createQueries(queryCount, seed, pairs);
+
+		std::vector<Query> queries;
+		for (auto& pair : pairs)
+			queries.push_back({ pair.first, pair.second });
+
+		fprintf(stderr, "%s: %u nodes\n", name.c_str(), (unsigned int)map.getNodes().size());
+
+		Engine* engines[] = {
+			new DijkstraEngine(),
+			new DijkstraFindFlagsEngine(),
+			new AStarEngine(),
+			new AStarInlineEngine(),
+			new CsrDijkstraEngine(),
+			new CsrAStarEngine(),
+			new BidirectionalEngine(),
+			new LandmarkEngine(false),
+			new LandmarkEngine(true),
+			new JumpPointEngine(),
+			new HierarchicalEngine(),
+		};
+
+		size_t first = results.size();
+
+		for (auto engine : engines) {
+
+			if (engine->canRun(map) == false)
+				continue;
+
+			results.push_back(run(map, *engine, queries));
+
+			// every optimal search should find paths costing the same
+			Result& result = results.back();
+			const Result& dijkstra = results[first];
+			if (engine->isOptimal()) {
+				result.checked = true;
+				result.matchesDijkstra = result.found == dijkstra.found &&
+					std::fabs(result.cost - dijkstra.cost) <= 0.01f * dijkstra.found;
+				if (result.matchesDijkstra == false)
+					fprintf(stderr, "warning: %s disagrees with dijkstra on %s\n", result.engine.c_str(), name.c_str());
+			}
+		}
+
+		for (auto engine : engines)
+			delete engine;
+	}
+
+	if (format == "json")
+		writeJson(file, results);
+	else
+		writeCsv(file, results);
+
+	if (file != stdout)
+		fclose(file);
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,308 @@
+#include "SteeringBehaviour.h"
+#include "AgentStore.h"
+#include "Agent.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+// a headless benchmark of the steering forces, comparing each force's
+// virtual getForce() called agent by agent on ai::Agents against its
+// batch accumulateForces() over an AgentStore holding the same agents.
+// Reports the median time of an update for each, as CSV or JSON, e.g.
+//   SteeringBench --counts 1000,100000 --forces seek,wander --format json
+// The batch forces use AVX if the build enables it (-mavx or /arch:AVX),
+// otherwise SSE2 where the target has it
+
+#if defined(STEERING_AVX)
+static const char* SIMD = "avx";
+#elif defined(STEERING_SSE)
+static const char* SIMD = "sse2";
+#else
+static const char* SIMD = "none";
+#endif
+
+struct Result {
+	unsigned int agents;
+	std::string force;
+	double virtualMilliseconds;
+	double batchMilliseconds;
+	double maxDifference;	// between the two paths' forces
+};
+
+static double median(std::vector<double>& values) {
+	std::sort(values.begin(), values.end());
+	return values.empty() ? 0 : values[values.size() / 2];
+}
+
+// times the forces both ways, adding them up for each agent
+static Result run(std::vector<ai::Agent>& agents, ai::AgentStore& store, const char* name,
+				  const std::vector<ai::SteeringForce*>& forces, unsigned int repeats) {
+
+	Result result;
+	result.agents = store.getCount();
+	result.force = name;
+
+	unsigned int count = store.getCount();
+
+	std::vector<glm::vec3> agentForces(count);
+	std::vector<float> forceX(count), forceY(count), forceZ(count);
+
+	std::vector<double> virtualTimes, batchTimes;
+
+	for (unsigned int repeat = 0; repeat < repeats; ++repeat) {
+
+		auto begin = std::chrono::high_resolution_clock::now();
+
+		for (unsigned int i = 0; i < count; ++i) {
+			glm::vec3 force(0);
+			for (auto f : forces)
+				force += f->getForce(&agents[i]);
+			agentForces[i] = force;
+		}
+
+		auto end = std::chrono::high_resolution_clock::now();
+		virtualTimes.push_back(std::chrono::duration<double, std::milli>(end - begin).count());
+
+		begin = std::chrono::high_resolution_clock::now();
+
+		std::fill(forceX.begin(), forceX.end(), 0.0f);
+		std::fill(forceY.begin(), forceY.end(), 0.0f);
+		std::fill(forceZ.begin(), forceZ.end(), 0.0f);
+
+		for (auto f : forces)
+			f->accumulateForces(store, 1, forceX.data(), forceY.data(), forceZ.data());
+
+		end = std::chrono::high_resolution_clock::now();
+		batchTimes.push_back(std::chrono::duration<double, std::milli>(end - begin).count());
+	}
+
+	result.virtualMilliseconds = median(virtualTimes);
+	result.batchMilliseconds = median(batchTimes);
+
+	// both wander from the same random states, so they can be compared too
+	result.maxDifference = 0;
+	for (unsigned int i = 0; i < count; ++i) {
+		glm::vec3 difference = agentForces[i] - glm::vec3(forceX[i], forceY[i], forceZ[i]);
+		result.maxDifference = std::max(result.maxDifference, (double)glm::length(difference));
+	}
+
+	return result;
+}
+
+static void writeCsv(FILE* file, const std::vector<Result>& results) {
+
+	fprintf(file, "agents,force,simd,virtual_ms,batch_ms,virtual_ns_per_agent,batch_ns_per_agent,speedup,max_difference\n");
+
+	for (auto& r : results) {
+		fprintf(file, "%u,%s,%s,%.3f,%.3f,%.2f,%.2f,%.2f,%g\n", r.agents, r.force.c_str(), SIMD,
+				r.virtualMilliseconds, r.batchMilliseconds,
+				r.virtualMilliseconds * 1e6 / r.agents, r.batchMilliseconds * 1e6 / r.agents,
+				r.batchMilliseconds > 0 ? r.virtualMilliseconds / r.batchMilliseconds : 0,
+				r.maxDifference);
+	}
+}
+
+static void writeJson(FILE* file, const std::vector<Result>& results) {
+
+	fprintf(file, "[\n");
+
+	for (size_t i = 0; i < results.size(); ++i) {
+		auto& r = results[i];
+		fprintf(file, "  { \"agents\": %u, \"force\": \"%s\", \"simd\": \"%s\", \"virtual_ms\": %.3f, \"batch_ms\": %.3f, ",
+				r.agents, r.force.c_str(), SIMD, r.virtualMilliseconds, r.batchMilliseconds);
+		fprintf(file, "\"virtual_ns_per_agent\": %.2f, \"batch_ns_per_agent\": %.2f, \"speedup\": %.2f, ",
+				r.virtualMilliseconds * 1e6 / r.agents, r.batchMilliseconds * 1e6 / r.agents,
+				r.batchMilliseconds > 0 ? r.virtualMilliseconds / r.batchMilliseconds : 0);
+		fprintf(file, "\"max_difference\": %g }", r.maxDifference);
+		fprintf(file, "%s\n", i + 1 < results.size() ? "," : "");
+	}
+
+	fprintf(file, "]\n");
+}
+
+static void printUsage() {
+	fprintf(stderr,
+			"usage: SteeringBench [options]\n"
+			"  --counts LIST   comma separated agent counts (default 1000,10000,100000,1000000)\n"
+			"  --forces LIST   comma separated from seek,flee,pursue,evade,wander,all\n"
+			"                  (default all of them)\n"
+			"  --repeats R     updates timed for each, the median is reported (default 9)\n"
+			"  --seed S        seed for the agents (default 1)\n"
+			"  --format F      csv or json (default csv)\n"
+			"  --out FILE      write results to a file rather than stdout\n");
+}
+
+// splits a comma separated list, skipping empty entries
+static std::vector<std::string> split(const std::string& list) {
+
+	std::vector<std::string> items;
+
+	size_t start = 0;
+	while (start <= list.size()) {
+
+		size_t comma = list.find(',', start);
+		if (comma == std::string::npos)
+			comma = list.size();
+
+		if (comma > start)
+			items.push_back(list.substr(start, comma - start));
+		start = comma + 1;
+	}
+
+	return items;
+}
+
+int main(int argc, char* argv[]) {
+
+	std::string counts = "1000,10000,100000,1000000";
+	std::string forceNames = "seek,flee,pursue,evade,wander,all";
+	unsigned int repeats = 9;
+	unsigned int seed = 1;
+	std::string format = "csv";
+	const char* out = nullptr;
+
+	for (int i = 1; i < argc; ++i) {
+
+		bool hasValue = i + 1 < argc;
+
+		if (strcmp(argv[i], "--counts") == 0 && hasValue)
+			counts = argv[++i];
+		else if (strcmp(argv[i], "--forces") == 0 && hasValue)
+			forceNames = argv[++i];
+		else if (strcmp(argv[i], "--repeats") == 0 && hasValue)
+			repeats = std::max(1u, (unsigned int)strtoul(argv[++i], nullptr, 10));
+		else if (strcmp(argv[i], "--seed") == 0 && hasValue)
+			seed = (unsigned int)strtoul(argv[++i], nullptr, 10);
+		else if (strcmp(argv[i], "--format") == 0 && hasValue)
+			format = argv[++i];
+		else if (strcmp(argv[i], "--out") == 0 && hasValue)
+			out = argv[++i];
+		else {
+			printUsage();
+			return 1;
+		}
+	}
+
+	if (format != "csv" &&
+		format != "json") {
+		printUsage();
+		return 1;
+	}
+
+	// a moving target for seek, flee, pursue and evade
+	ai::Agent target;
+	target.setPosition({ 512, 384, 0 });
+	target.getBlackboard().set("velocity", new glm::vec3(50, 20, 0), true);
+
+	ai::SeekForce seek(&target);
+	ai::FleeForce flee(&target);
+	ai::PursueForce pursue(&target);
+	ai::EvadeForce evade(&target);
+	ai::WanderForce wander;
+
+	struct NamedForce {
+		const char* name;
+		ai::SteeringForce* force;
+	};
+	NamedForce available[] = {
+		{ "seek", &seek },
+		{ "flee", &flee },
+		{ "pursue", &pursue },
+		{ "evade", &evade },
+		{ "wander", &wander },
+	};
+
+	std::vector<std::pair<std::string, std::vector<ai::SteeringForce*>>> runs;
+	for (auto& name : split(forceNames)) {
+
+		std::vector<ai::SteeringForce*> forces;
+		for (auto& f : available) {
+			if (name == "all" ||
+				name == f.name)
+				forces.push_back(f.force);
+		}
+
+		if (forces.empty()) {
+			fprintf(stderr, "unknown force %s\n", name.c_str());
+			printUsage();
+			return 1;
+		}
+
+		runs.push_back(std::make_pair(name, forces));
+	}
+
+	FILE* file = stdout;
+	if (out != nullptr) {
+		file = fopen(out, "w");
+		if (file == nullptr) {
+			fprintf(stderr, "failed to open %s\n", out);
+			return 1;
+		}
+	}
+
+	std::vector<Result> results;
+
+	for (auto& item : split(counts)) {
+
+		unsigned int count = (unsigned int)strtoul(item.c_str(), nullptr, 10);
+		if (count == 0)
+			continue;
+
+		fprintf(stderr, "%u agents\n", count);
+
+		// the same agents both ways, one size at a time so that
+		// only one set is in memory
+		std::mt19937 random(seed);
+		std::uniform_real_distribution<float> coordinate(0, 1024);
+		std::uniform_real_distribution<float> angle(0, 3.14159f * 2);
+
+		std::vector<ai::Agent> agents(count);
+		ai::AgentStore store;
+		store.reserve(count);
+
+		for (unsigned int i = 0; i < count; ++i) {
+
+			glm::vec3 position(coordinate(random), coordinate(random), 0);
+
+			float a = angle(random);
+			glm::vec3 velocity(sinf(a) * 100, cosf(a) * 100, 0);
+
+			agents[i].setPosition(position);
+			agents[i].getBlackboard().set("velocity", new glm::vec3(velocity), true);
+			agents[i].getBlackboard().set("maxForce", 250.f);
+			agents[i].getBlackboard().set("maxVelocity", 100.f);
+
+			ai::WanderData* wd = new ai::WanderData();
+			wd->offset = 100;
+			wd->radius = 75;
+			wd->jitter = 25;
+			wd->target = { 0, 0, 0 };
+			wd->axisWeights = { 1, 1, 0 };
+			wd->randomState = (unsigned int)random() | 1;
+			agents[i].getBlackboard().set("wanderData", wd, true);
+
+			store.add(position, velocity, 250, 100);
+			store.setWander(i, wd->offset, wd->radius, wd->jitter, wd->axisWeights, wd->randomState);
+		}
+
+		for (auto& forces : runs)
+			results.push_back(run(agents, store, forces.first.c_str(), forces.second, repeats));
+	}
+
+	if (format == "json")
+		writeJson(file, results);
+	else
+		writeCsv(file, results);
+
+	if (file != stdout)
+		fclose(file);
+
+	return 0;
+}
\ No newline at end of file